@@ -0,0 +1,268 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "capturefile.h"
+#include <QtEndian>
+#include <cstring>
+
+template <typename T> static void appendLittleEndian(QByteArray &buffer, T value) {
+  T littleEndian = qToLittleEndian(value);
+  buffer.append(reinterpret_cast<const char *>(&littleEndian), sizeof(T));
+}
+
+static void appendDouble(QByteArray &buffer, double value) {
+  quint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  appendLittleEndian(buffer, bits);
+}
+
+static double readDouble(const char *data) {
+  quint64 bits = qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(data));
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+bool CaptureWriter::open(const QString &fileName, qint64 preallocate) {
+  close();
+  file.setFileName(fileName);
+  lost = 0;
+  error.clear();
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+    error = file.errorString();
+    return false;
+  }
+  if (preallocate > 0)
+    file.resize(preallocate);
+  buffer.clear();
+  buffer.reserve(CAPTURE_WRITE_BUFFER);
+  index.clear();
+  buffer.append(CaptureFile::FileMagic, CaptureFile::MagicSize);
+  appendLittleEndian<quint32>(buffer, CaptureFile::Version);
+  appendLittleEndian<quint32>(buffer, 0);
+  position = buffer.size();
+  written = 0;
+  bufferedPayload = 0;
+  return true;
+}
+
+void CaptureWriter::appendChunkHeader(quint32 type, qint32 channel, qint64 timestamp, quint64 length) {
+  if (type != CaptureFile::index)
+    index.append(QPair<qint64, qint64>(timestamp, position));
+  appendLittleEndian<quint32>(buffer, type);
+  appendLittleEndian<qint32>(buffer, channel);
+  appendLittleEndian<qint64>(buffer, timestamp);
+  appendLittleEndian<quint64>(buffer, length);
+  position += CaptureFile::ChunkHeaderSize;
+}
+
+bool CaptureWriter::writeRaw(qint64 timestamp, const QByteArray &data) {
+  if (!file.isOpen()) {
+    lost += data.size();
+    return false;
+  }
+  appendChunkHeader(CaptureFile::raw, 0, timestamp, data.size());
+  buffer.append(data);
+  position += data.size();
+  bufferedPayload += data.size();
+  if (buffer.size() >= CAPTURE_WRITE_BUFFER)
+    return flush();
+  return true;
+}
+
+bool CaptureWriter::writeDecoded(qint64 timestamp, int channel, const double *times, const double *values, int count) {
+  qint64 length = (qint64)count * 2 * sizeof(double);
+  if (!file.isOpen()) {
+    lost += length;
+    return false;
+  }
+  appendChunkHeader(CaptureFile::decoded, channel, timestamp, length);
+  for (int i = 0; i < count; i++)
+    appendDouble(buffer, times[i]);
+  for (int i = 0; i < count; i++)
+    appendDouble(buffer, values[i]);
+  position += length;
+  bufferedPayload += length;
+  if (buffer.size() >= CAPTURE_WRITE_BUFFER)
+    return flush();
+  return true;
+}
+
+bool CaptureWriter::flush() {
+  if (file.write(buffer) != buffer.size()) {
+    fail();
+    return false;
+  }
+  buffer.clear();
+  bufferedPayload = 0;
+  written = position;
+  return true;
+}
+
+void CaptureWriter::fail() {
+  error = file.errorString();
+  lost += bufferedPayload;
+  buffer.clear();
+  bufferedPayload = 0;
+  // Partially written chunk is cut off, the file stays readable by scanning
+  file.resize(written);
+  file.close();
+  index.clear();
+  position = 0;
+}
+
+bool CaptureWriter::close() {
+  if (!file.isOpen())
+    return true;
+  qint64 indexOffset = position;
+  appendChunkHeader(CaptureFile::index, 0, 0, (quint64)index.size() * CaptureFile::IndexEntrySize);
+  for (const auto &entry : qAsConst(index)) {
+    appendLittleEndian<qint64>(buffer, entry.first);
+    appendLittleEndian<quint64>(buffer, entry.second);
+  }
+  appendLittleEndian<quint64>(buffer, indexOffset);
+  buffer.append(CaptureFile::IndexMagic, CaptureFile::MagicSize);
+  position += (qint64)index.size() * CaptureFile::IndexEntrySize + CaptureFile::TrailerSize;
+  if (!flush())
+    return false;
+  if (file.size() > position)
+    file.resize(position);
+  file.close();
+  index.clear();
+  position = 0;
+  return true;
+}
+
+bool CaptureReader::open(const QString &fileName) {
+  close();
+  file.setFileName(fileName);
+  if (!file.open(QFile::ReadOnly)) {
+    error = file.errorString();
+    return false;
+  }
+  mapSize = file.size();
+  if (mapSize < CaptureFile::FileHeaderSize || (map = file.map(0, mapSize)) == nullptr || std::memcmp(map, CaptureFile::FileMagic, CaptureFile::MagicSize) != 0) {
+    error = QObject::tr("Not a capture file");
+    close();
+    return false;
+  }
+
+  // Index at the end of the file, if the recording was properly finished
+  if (mapSize >= CaptureFile::FileHeaderSize + CaptureFile::ChunkHeaderSize + CaptureFile::TrailerSize && std::memcmp(map + mapSize - CaptureFile::MagicSize, CaptureFile::IndexMagic, CaptureFile::MagicSize) == 0) {
+    qint64 indexOffset = qFromLittleEndian<quint64>(map + mapSize - CaptureFile::TrailerSize);
+    if (indexOffset >= CaptureFile::FileHeaderSize && indexOffset + CaptureFile::ChunkHeaderSize <= mapSize - CaptureFile::TrailerSize) {
+      const uchar *header = map + indexOffset;
+      qint64 length = qFromLittleEndian<quint64>(header + 16);
+      if (qFromLittleEndian<quint32>(header) == CaptureFile::index && indexOffset + CaptureFile::ChunkHeaderSize + length == mapSize - CaptureFile::TrailerSize) {
+        indexData = header + CaptureFile::ChunkHeaderSize;
+        count = length / CaptureFile::IndexEntrySize;
+        return true;
+      }
+    }
+  }
+
+  scanChunks();
+  return true;
+}
+
+void CaptureReader::scanChunks() {
+  // Walks the chunk headers, an incomplete chunk at the end is ignored
+  scannedOffsets.clear();
+  qint64 offset = CaptureFile::FileHeaderSize;
+  while (offset + CaptureFile::ChunkHeaderSize <= mapSize) {
+    const uchar *header = map + offset;
+    quint32 type = qFromLittleEndian<quint32>(header);
+    qint64 length = qFromLittleEndian<quint64>(header + 16);
+    // Zero type is the unused preallocated space of an unfinished file
+    if (type == 0 || length < 0 || length > mapSize - offset - CaptureFile::ChunkHeaderSize)
+      break;
+    if (type == CaptureFile::raw || type == CaptureFile::decoded)
+      scannedOffsets.append(offset);
+    offset += CaptureFile::ChunkHeaderSize + length;
+  }
+  count = scannedOffsets.size();
+}
+
+void CaptureReader::close() {
+  if (map != nullptr)
+    file.unmap(const_cast<uchar *>(map));
+  map = nullptr;
+  mapSize = 0;
+  indexData = nullptr;
+  scannedOffsets.clear();
+  count = 0;
+  if (file.isOpen())
+    file.close();
+}
+
+qint64 CaptureReader::chunkOffset(int number) const {
+  if (indexData != nullptr)
+    return qFromLittleEndian<quint64>(indexData + (qint64)number * CaptureFile::IndexEntrySize + 8);
+  return scannedOffsets.at(number);
+}
+
+qint64 CaptureReader::timestamp(int number) const {
+  if (indexData != nullptr)
+    return qFromLittleEndian<qint64>(indexData + (qint64)number * CaptureFile::IndexEntrySize);
+  return qFromLittleEndian<qint64>(map + scannedOffsets.at(number) + 8);
+}
+
+CaptureReader::Chunk CaptureReader::chunk(int number) const {
+  Chunk chunk;
+  qint64 offset = chunkOffset(number);
+  if (offset < CaptureFile::FileHeaderSize || offset + CaptureFile::ChunkHeaderSize > mapSize)
+    return chunk;
+  const uchar *header = map + offset;
+  qint64 length = qFromLittleEndian<quint64>(header + 16);
+  if (length < 0 || length > mapSize - offset - CaptureFile::ChunkHeaderSize)
+    return chunk;
+  chunk.type = qFromLittleEndian<quint32>(header);
+  chunk.channel = qFromLittleEndian<qint32>(header + 4);
+  chunk.timestamp = qFromLittleEndian<qint64>(header + 8);
+  chunk.data = reinterpret_cast<const char *>(header + CaptureFile::ChunkHeaderSize);
+  chunk.length = length;
+  return chunk;
+}
+
+int CaptureReader::findChunk(qint64 time) const {
+  int low = 0, high = count;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    if (timestamp(middle) < time)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+QByteArray CaptureReader::decodedToPoints(const Chunk &chunk) {
+  if (chunk.type != CaptureFile::decoded || chunk.channel < 1 || chunk.channel > ANALOG_COUNT)
+    return QByteArray();
+  int samples = chunk.length / (2 * sizeof(double));
+  // Values of preceding channels are left empty
+  QByteArray skipped = QByteArray(",-").repeated(chunk.channel - 1);
+  QByteArray result;
+  result.reserve(samples * (48 + skipped.size()));
+  for (int i = 0; i < samples; i++) {
+    result.append("$$P");
+    result.append(QByteArray::number(readDouble(chunk.data + i * sizeof(double)), 'g', 17));
+    result.append(skipped);
+    result.append(',');
+    result.append(QByteArray::number(readDouble(chunk.data + (samples + i) * sizeof(double)), 'g', 17));
+    result.append(';');
+  }
+  return result;
+}
@@ -0,0 +1,126 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include "global.h"
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+
+/// Native capture file, holds received data so that a session can be replayed later.
+///
+/// Layout (all numbers are little-endian):
+///   header  - magic "DPCAPTUR", uint32 version, uint32 reserved
+///   chunk   - uint32 type, int32 channel, int64 timestamp [ns since start of capture], uint64 payload length, payload
+///   index   - chunk of type index, payload is (int64 timestamp, uint64 file offset) of every data chunk
+///   trailer - uint64 file offset of the index chunk, magic "DPCINDEX"
+/// Raw chunks hold bytes exactly as received, decoded chunks hold samples of one channel
+/// as a column of times followed by a column of values (both double).
+/// Decoded channels are numbered from 1, numbers above ANALOG_COUNT + MATH_COUNT are logic bits (value 0 or 1).
+/// A file without the trailer (recording was interrupted) is still readable, its chunks are found by scanning.
+namespace CaptureFile {
+enum ChunkType : quint32 { raw = 1, decoded = 2, index = 3 };
+const char FileMagic[] = "DPCAPTUR";
+const char IndexMagic[] = "DPCINDEX";
+const quint32 Version = 1;
+const int MagicSize = 8;
+const int FileHeaderSize = 16;
+const int ChunkHeaderSize = 24;
+const int IndexEntrySize = 16;
+const int TrailerSize = 16;
+} // namespace CaptureFile
+
+class CaptureWriter {
+public:
+  ~CaptureWriter() { close(); }
+
+  /// Creates the file, with preallocate > 0 the space is reserved in advance (unused part is cut off on close)
+  bool open(const QString &fileName, qint64 preallocate = 0);
+  bool isOpen() const { return file.isOpen(); }
+  QString fileName() const { return file.fileName(); }
+  /// Appends bytes exactly as received.
+  /// Returns false if the data could not be written, the file is then closed without the index
+  /// (cut off after the last complete write) and lostBytes() counts the payload that never reached it.
+  bool writeRaw(qint64 timestamp, const QByteArray &data);
+  /// Appends decoded samples of one channel, fails the same way as writeRaw()
+  bool writeDecoded(qint64 timestamp, int channel, const double *times, const double *values, int count);
+  /// Writes the buffered data, the index and the trailer and closes the file, returns false if writing failed
+  bool close();
+  /// Size of the file including data not yet written
+  qint64 size() const { return position; }
+  /// Payload bytes (raw data or samples) that were accepted but could not be written since open()
+  qint64 lostBytes() const { return lost; }
+  QString errorString() const { return error; }
+
+private:
+  QFile file;
+  QByteArray buffer;
+  /// File offset of the end of the buffer
+  qint64 position = 0;
+  /// File offset of the end of the data successfully written
+  qint64 written = 0;
+  /// Payload bytes in the buffer
+  qint64 bufferedPayload = 0;
+  qint64 lost = 0;
+  QString error;
+  QVector<QPair<qint64, qint64>> index;
+  void appendChunkHeader(quint32 type, qint32 channel, qint64 timestamp, quint64 length);
+  bool flush();
+  void fail();
+};
+
+/// Reads a capture file mapped into memory, so only the accessed parts of the file are loaded.
+class CaptureReader {
+public:
+  struct Chunk {
+    quint32 type = 0;
+    int channel = 0;
+    qint64 timestamp = 0;
+    /// Payload, valid while the reader is open
+    const char *data = nullptr;
+    qint64 length = 0;
+  };
+
+  ~CaptureReader() { close(); }
+
+  bool open(const QString &fileName);
+  void close();
+  QString errorString() const { return error; }
+  /// Number of data chunks (raw and decoded)
+  int chunkCount() const { return count; }
+  Chunk chunk(int number) const;
+  qint64 timestamp(int number) const;
+  /// Number of the first chunk with timestamp at least time (chunkCount(), if there is none)
+  int findChunk(qint64 time) const;
+
+  /// Converts decoded chunk to point mode messages, so it can be replayed through the parser (analog channels only)
+  static QByteArray decodedToPoints(const Chunk &chunk);
+
+private:
+  QFile file;
+  const uchar *map = nullptr;
+  qint64 mapSize = 0;
+  QString error;
+  int count = 0;
+  /// Index entries inside the mapped file (null if the index was built by scanning)
+  const uchar *indexData = nullptr;
+  QVector<qint64> scannedOffsets;
+  qint64 chunkOffset(int number) const;
+  void scanChunks();
+};
+
+#endif // CAPTUREFILE_H
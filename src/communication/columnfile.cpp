@@ -0,0 +1,176 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "columnfile.h"
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+template <typename T> static void appendLittleEndian(QByteArray &buffer, T value) {
+  T littleEndian = qToLittleEndian(value);
+  buffer.append(reinterpret_cast<const char *>(&littleEndian), sizeof(T));
+}
+
+static quint64 doubleBits(double value) {
+  quint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static quint32 floatBits(float value) {
+  quint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/// Stores little-endian bytes of values grouped by their position (all first bytes, then all second bytes...)
+template <typename T> static void shuffle(QByteArray &column, const T *values, int count) {
+  column.resize(count * (int)sizeof(T));
+  uchar *output = reinterpret_cast<uchar *>(column.data());
+  for (int i = 0; i < count; i++) {
+    T value = values[i];
+    for (int byte = 0; byte < (int)sizeof(T); byte++) {
+      output[byte * count + i] = value & 0xFF;
+      value >>= 8;
+    }
+  }
+}
+
+bool ColumnFileWriter::open(const QString &fileName) {
+  close();
+  file.setFileName(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    return false;
+  channels.clear();
+  failed = false;
+  QByteArray header;
+  header.append(ColumnFile::FileMagic, ColumnFile::MagicSize);
+  appendLittleEndian<quint32>(header, ColumnFile::Version);
+  appendLittleEndian<quint32>(header, 0);
+  if (file.write(header) != header.size())
+    failed = true;
+  position = header.size();
+  return !failed;
+}
+
+void ColumnFileWriter::beginChannel(const QString &name, ColumnFile::ValueType type, double t0, double dt) {
+  channels.append(Channel{name, type, t0, dt, 0, {}});
+}
+
+void ColumnFileWriter::writeCompressed(qint64 &offset, quint32 &size) {
+  QByteArray compressed = qCompress(reinterpret_cast<const uchar *>(column.constData()), column.size(), COLUMN_FILE_COMPRESSION);
+  offset = position;
+  size = compressed.size();
+  if (file.write(compressed) != compressed.size())
+    failed = true;
+  position += compressed.size();
+}
+
+bool ColumnFileWriter::writeBlock(const QCPGraphData *data, int count) {
+  if (!file.isOpen() || channels.isEmpty() || count <= 0)
+    return false;
+  Channel &channel = channels.last();
+  Block block{(quint32)count, data[0].key, 0, 0, 0, 0};
+
+  if (channel.type == ColumnFile::float64) {
+    QVector<quint64> values(count);
+    for (int i = 0; i < count; i++)
+      values[i] = doubleBits(data[i].value);
+    shuffle(column, values.constData(), count);
+  } else if (channel.type == ColumnFile::float32) {
+    QVector<quint32> values(count);
+    for (int i = 0; i < count; i++)
+      values[i] = floatBits((float)data[i].value);
+    shuffle(column, values.constData(), count);
+  } else {
+    QVector<quint8> values(count);
+    for (int i = 0; i < count; i++)
+      values[i] = ((int)round(data[i].value) % 3) ? 1 : 0;
+    shuffle(column, values.constData(), count);
+  }
+  writeCompressed(block.valueOffset, block.valueSize);
+
+  if (channel.dt <= 0) {
+    QVector<quint64> times(count);
+    for (int i = 0; i < count; i++)
+      times[i] = doubleBits(data[i].key);
+    shuffle(column, times.constData(), count);
+    writeCompressed(block.timeOffset, block.timeSize);
+  }
+
+  channel.blocks.append(block);
+  channel.samples += count;
+  return !failed;
+}
+
+bool ColumnFileWriter::close() {
+  if (!file.isOpen())
+    return false;
+  QByteArray footer;
+  appendLittleEndian<quint32>(footer, channels.size());
+  for (const Channel &channel : qAsConst(channels)) {
+    QByteArray name = channel.name.toUtf8();
+    appendLittleEndian<quint32>(footer, name.size());
+    footer.append(name);
+    appendLittleEndian<quint8>(footer, channel.type);
+    footer.append(3, '\0');
+    appendLittleEndian<quint64>(footer, channel.samples);
+    appendLittleEndian<quint64>(footer, doubleBits(channel.t0));
+    appendLittleEndian<quint64>(footer, doubleBits(channel.dt));
+    appendLittleEndian<quint32>(footer, channel.blocks.size());
+    for (const Block &block : channel.blocks) {
+      appendLittleEndian<quint32>(footer, block.samples);
+      appendLittleEndian<quint32>(footer, 0);
+      appendLittleEndian<quint64>(footer, doubleBits(block.firstTime));
+      appendLittleEndian<quint64>(footer, block.valueOffset);
+      appendLittleEndian<quint64>(footer, block.timeOffset);
+      appendLittleEndian<quint32>(footer, block.valueSize);
+      appendLittleEndian<quint32>(footer, block.timeSize);
+    }
+  }
+  appendLittleEndian<quint64>(footer, position);
+  footer.append(ColumnFile::FooterMagic, ColumnFile::MagicSize);
+  if (file.write(footer) != footer.size())
+    failed = true;
+  file.close();
+  channels.clear();
+  column.clear();
+  return !failed;
+}
+
+ColumnFile::ValueType ColumnFileWriter::valueType(const ChannelSnapshot &data, bool isLogic) {
+  if (isLogic)
+    return ColumnFile::uint8;
+  for (auto it = data.constBegin(); it != data.constEnd(); it++)
+    if ((double)(float)it->value != it->value && !qIsNaN(it->value))
+      return ColumnFile::float64;
+  return ColumnFile::float32;
+}
+
+bool ColumnFileWriter::uniformTime(const ChannelSnapshot &data, double &t0, double &dt) {
+  int count = data.size();
+  if (count < 2)
+    return false;
+  t0 = data.at(0).key;
+  dt = (data.at(count - 1).key - t0) / (count - 1);
+  if (!(dt > 0))
+    return false;
+  // Times of a channel are computed by adding the time step, they differ from t0 + i * dt only by rounding
+  double tolerance = dt * COLUMN_FILE_TIME_TOLERANCE;
+  for (int i = 0; i < count; i++)
+    if (std::fabs(data.at(i).key - (t0 + i * dt)) > tolerance)
+      return false;
+  return true;
+}
@@ -0,0 +1,93 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COLUMNFILE_H
+#define COLUMNFILE_H
+
+#include "global.h"
+#include "math/channelsnapshot.h"
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+
+/// Binary table export, every channel is stored as its own typed column, so it is much smaller and faster to load than CSV.
+///
+/// Layout (all numbers are little-endian):
+///   header  - magic "DPCOLUMN", uint32 version, uint32 reserved
+///   blocks  - compressed columns of at most COLUMN_FILE_BLOCK_SAMPLES samples
+///   footer  - uint32 channel count, for each channel:
+///               uint32 name length, name (UTF-8), uint8 value type, uint8 reserved[3], uint64 sample count,
+///               double t0, double dt (time of sample i is t0 + i * dt, dt is 0 if times are stored as a column),
+///               uint32 block count, for each block:
+///                 uint32 samples, uint32 reserved, double time of the first sample,
+///                 uint64 offset of the values, uint64 offset of the times, uint32 size of the values, uint32 size of the times (0 if not stored)
+///   trailer - uint64 file offset of the footer, magic "DPCFOOTR"
+/// Each block is compressed by qCompress (4 byte big-endian uncompressed size followed by zlib stream).
+/// Before compression bytes of the values are shuffled (all first bytes, then all second bytes...), which makes them compress much better.
+namespace ColumnFile {
+enum ValueType : quint8 { float64 = 1, float32 = 2, uint8 = 3 };
+const char FileMagic[] = "DPCOLUMN";
+const char FooterMagic[] = "DPCFOOTR";
+const quint32 Version = 1;
+const int MagicSize = 8;
+const int FileHeaderSize = 16;
+const int TrailerSize = 16;
+} // namespace ColumnFile
+
+class ColumnFileWriter {
+public:
+  ~ColumnFileWriter() { close(); }
+
+  bool open(const QString &fileName);
+  bool isOpen() const { return file.isOpen(); }
+  /// Starts a new channel, with dt > 0 only t0 and dt are stored instead of the time column
+  void beginChannel(const QString &name, ColumnFile::ValueType type, double t0 = 0, double dt = 0);
+  /// Appends a block of samples to the current channel, logic values (type uint8) are stored as 0/1
+  bool writeBlock(const QCPGraphData *data, int count);
+  /// Writes the footer and closes the file, returns false if anything failed to be written
+  bool close();
+  QString errorString() const { return file.errorString(); }
+
+  /// Smallest type holding all values of the channel without loss
+  static ColumnFile::ValueType valueType(const ChannelSnapshot &data, bool isLogic);
+  /// Detects constant sampling period (as sent in channel mode), returns false if times are not uniform
+  static bool uniformTime(const ChannelSnapshot &data, double &t0, double &dt);
+
+private:
+  struct Block {
+    quint32 samples;
+    double firstTime;
+    qint64 valueOffset;
+    quint32 valueSize;
+    qint64 timeOffset;
+    quint32 timeSize;
+  };
+  struct Channel {
+    QString name;
+    ColumnFile::ValueType type;
+    double t0, dt;
+    quint64 samples;
+    QVector<Block> blocks;
+  };
+
+  QFile file;
+  qint64 position = 0;
+  bool failed = false;
+  QVector<Channel> channels;
+  QByteArray column;
+  void writeCompressed(qint64 &offset, quint32 &size);
+};
+
+#endif // COLUMNFILE_H
@@ -14,6 +14,7 @@
 //  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "newserialparser.h"
+#include <cstring>
 
 NewSerialParser::NewSerialParser(MessageTarget::enumMessageTarget target, QObject *parent) : QObject(parent) {
   this->target = target;
@@ -44,8 +45,8 @@ void NewSerialParser::sendMessageIfAllowed(QString header, QString message, Mess
 }
 
 void NewSerialParser::showBuffer() {
-  if ((!buffer.isEmpty()) || (!pendingDataBuffer.isEmpty())) {
-    QByteArray bufferToPrint = pendingDataBuffer + buffer;
+  if (available() > 0 || (!pendingDataBuffer.isEmpty())) {
+    QByteArray bufferToPrint = pendingDataBuffer + buffer.mid(readPos);
     // replace non-printable characters with their hex value
     for (unsigned char ch = 0;; ch++) {
       if (ch == 32)
@@ -62,7 +63,13 @@ void NewSerialParser::showBuffer() {
     foreach (auto line, pendingPointBuffer)
       emit sendMessage("->" + valueTypeToString(line.first).toUtf8(), (line.first.isBinary ? line.second.toHex() : line.second), MessageLevel::info, target);
   }
-  if (buffer.isEmpty() && pendingDataBuffer.isEmpty() && pendingPointBuffer.isEmpty())
+  bool pendingPointEmpty = pendingPoint.isNull() || pendingPoint->columns.isEmpty();
+  if (!pendingPointEmpty) {
+    emit sendMessage(tr("Point buffer content"), QByteArray(), MessageLevel::info, target);
+    foreach (auto column, pendingPoint->columns)
+      emit sendMessage("->" + valueTypeToString(column.type).toUtf8(), pointColumnToText(column), MessageLevel::info, target);
+  }
+  if (available() == 0 && pendingDataBuffer.isEmpty() && pendingPointBuffer.isEmpty() && pendingPointEmpty)
     emit sendMessage(tr("Buffer is empty"), "", MessageLevel::info, target);
 }
 
@@ -87,30 +94,33 @@ void NewSerialParser::clearBuffer() {
     pendingDataBuffer.clear();
   if (!pendingPointBuffer.isEmpty())
     pendingPointBuffer.clear();
+  pendingPoint.reset();
   if (!buffer.isEmpty())
     buffer.clear();
+  readPos = 0;
+  scannedLength = 0;
   changeMode(DataMode::unknown, currentMode, tr("Unknown").toUtf8());
   resetChHeader();
 }
 
 void NewSerialParser::parse(QByteArray newData) {
   buffer.push_back(newData);
-  while (!buffer.isEmpty()) {
+  while (available() > 0) {
     try {
-      if (buffer.length() >= 3) {
-        if (buffer.left(2) == "$$") {
+      if (available() >= 3) {
+        if (peek(0) == '$' && peek(1) == '$') {
           if (currentMode == DataMode::info || currentMode == DataMode::warning)
             emit sendDeviceMessage("", false, true); // If the previous mode was a message print, announce its end
           if (currentMode == DataMode::initialEcho)
             initialEchoPending = false;
-          parseMode(buffer.at(2));
-          buffer.remove(0, 3);
+          parseMode(peek(2));
+          consume(3);
           continue;
         }
       } else {
-        if (buffer == "$")
+        if (available() == 1 && peek(0) == '$')
           break;
-        if (buffer == "$$")
+        if (available() == 2 && peek(0) == '$' && peek(1) == '$')
           break;
       }
 
@@ -121,9 +131,12 @@ void NewSerialParser::parse(QByteArray newData) {
       }*/
 
       if (currentMode == DataMode::point) {
+        // Values are decoded directly into the batch that is sent to PlotData
+        if (pendingPoint.isNull())
+          pendingPoint = SampleBatchPool::getInstance().acquire();
         readResult result;
         try {
-          result = bufferReadPoint(pendingPointBuffer);
+          result = bufferReadPoint(pendingPointBuffer, pendingPoint.data());
         } catch (QString msg) {
           throw(tr("Error reading point: ") + msg);
         }
@@ -131,18 +144,18 @@ void NewSerialParser::parse(QByteArray newData) {
         if (result == incomplete)
           break;
 
-        if (pendingPointBuffer.length() < 2)
+        if (pendingPoint->columns.length() < 2)
           throw(tr("Point has no value"));
 
         if (result == complete) {
-          emit sendPoint(pendingPointBuffer);
-          pendingPointBuffer.clear();
+          emit sendPoint(pendingPoint);
+          pendingPoint.reset();
           continue;
         }
         if (result == notProperlyEnded) {
-          sendMessageIfAllowed(tr("Missing semicolon ?"), pendingPointBuffer.last().second, MessageLevel::warning);
-          emit sendPoint(pendingPointBuffer);
-          pendingPointBuffer.clear();
+          sendMessageIfAllowed(tr("Missing semicolon ?"), pointColumnToText(pendingPoint->columns.last()), MessageLevel::warning);
+          emit sendPoint(pendingPoint);
+          pendingPoint.reset();
           continue;
         }
       }
@@ -279,13 +292,14 @@ void NewSerialParser::parse(QByteArray newData) {
             QByteArray semicolonPositionMessage = tr("(enable info messages to show nearest semicolon position)").toUtf8();
             if (debugLevel == OutputLevel::info) {
               semicolonPositionMessage = tr("No semicolon found").toUtf8();
-              if (buffer.contains(';') && channel.second.contains(';'))
-                semicolonPositionMessage = tr("There are semicolons %1 byte before and %2 after end.").arg(buffer.indexOf(';')).arg(channel.second.length() - channel.second.lastIndexOf(';')).toUtf8();
+              int nextSemicolon = findInBuffer(';');
+              if (nextSemicolon >= 0 && channel.second.contains(';'))
+                semicolonPositionMessage = tr("There are semicolons %1 byte before and %2 after end.").arg(nextSemicolon).arg(channel.second.length() - channel.second.lastIndexOf(';')).toUtf8();
               else {
                 if (channel.second.contains(';'))
                   semicolonPositionMessage = tr("There is semicolon %1 bytes before end.").arg(channel.second.length() - channel.second.lastIndexOf(';')).toUtf8();
-                if (buffer.contains(';'))
-                  semicolonPositionMessage = tr("There is semicolon %1 bytes after end.").arg(buffer.indexOf(';')).toUtf8();
+                if (nextSemicolon >= 0)
+                  semicolonPositionMessage = tr("There is semicolon %1 bytes after end.").arg(nextSemicolon).toUtf8();
               }
             }
 
@@ -351,17 +365,16 @@ void NewSerialParser::parse(QByteArray newData) {
                 throw(tr("Invalid channel: ") + tr("To many header entries for signed integer type"));
             }
           }
-          if (channelNumber.size() == 1)
-            emit sendChannel(channel, channelNumber.first(), channelTime, zeroIndex, channelBits, channelMin, channelMax);
-          else {
-            int N = channelNumber.size();
-            QVector<QByteArray> subChannels;
-            subChannels.resize(N);
-            for (int i = 0; i < channel.second.size(); i++)
-              subChannels[(i / channel.first.bytes) % N].append(channel.second.at(i));
-            for (int i = 0; i < N; i++)
-              emit sendChannel(QPair<ValueType, QByteArray>(channel.first, subChannels.at(i)), channelNumber.at(i), channelTime, zeroIndex, channelBits, channelMin, channelMax);
-          }
+          QSharedPointer<SampleBatch> batch = SampleBatchPool::getInstance().acquire();
+          batch->timeStep = batch->decodeField(channelTime);
+          batch->minimum = batch->decodeField(channelMin);
+          batch->maximum = batch->decodeField(channelMax);
+          batch->zeroIndex = zeroIndex;
+          batch->bits = channelBits;
+          // Multiple channels are interleaved sample by sample
+          for (int i = 0; i < channelNumber.size(); i++)
+            batch->appendChannel(channel.first, channel.second.constData(), channel.second.length(), channelNumber.at(i), channelNumber.size(), i);
+          emit sendChannel(batch);
           resetChHeader();
           continue;
         }
@@ -412,13 +425,14 @@ void NewSerialParser::parse(QByteArray newData) {
             QByteArray semicolonPositionMessage = tr("(enable info messages to show nearest semicolon position)").toUtf8();
             if (debugLevel == OutputLevel::info) {
               semicolonPositionMessage = tr("No semicolon found").toUtf8();
-              if (buffer.contains(';') && channel.second.contains(';'))
-                semicolonPositionMessage = tr("There are semicolons %1 byte before and %2 after end.").arg(buffer.indexOf(';')).arg(channel.second.length() - channel.second.lastIndexOf(';')).toUtf8();
+              int nextSemicolon = findInBuffer(';');
+              if (nextSemicolon >= 0 && channel.second.contains(';'))
+                semicolonPositionMessage = tr("There are semicolons %1 byte before and %2 after end.").arg(nextSemicolon).arg(channel.second.length() - channel.second.lastIndexOf(';')).toUtf8();
               else {
                 if (channel.second.contains(';'))
                   semicolonPositionMessage = tr("There is semicolon %1 bytes before end.").arg(channel.second.length() - channel.second.lastIndexOf(';')).toUtf8();
-                if (buffer.contains(';'))
-                  semicolonPositionMessage = tr("There is semicolon %1 bytes after end.").arg(buffer.indexOf(';')).toUtf8();
+                if (nextSemicolon >= 0)
+                  semicolonPositionMessage = tr("There is semicolon %1 bytes after end.").arg(nextSemicolon).toUtf8();
               }
             }
             emit sendMessage(tr("Logic channel not ended with ';'"), semicolonPositionMessage, MessageLevel::warning, target);
@@ -590,15 +604,17 @@ void NewSerialParser::parse(QByteArray newData) {
 
     } catch (QString message) {
       sendMessageIfAllowed(tr("Parsing error"), message, MessageLevel::error);
-      if (!buffer.isEmpty()) {
-        if (buffer.contains("$$"))
-          buffer.remove(0, buffer.indexOf("$$"));
+      if (available() > 0) {
+        int nextModeStart = findInBuffer("$$");
+        if (nextModeStart >= 0)
+          consume(nextModeStart);
         else
-          buffer.clear();
+          consume(available());
         if (!pendingDataBuffer.isEmpty())
           pendingDataBuffer.clear();
         if (!pendingPointBuffer.isEmpty())
           pendingPointBuffer.clear();
+        pendingPoint.reset();
         resetChHeader();
       }
       changeMode(DataMode::unknown, currentMode, tr("Unknown").toUtf8());
@@ -606,108 +622,141 @@ void NewSerialParser::parse(QByteArray newData) {
       sendMessageIfAllowed(tr("Fatal error"), QString(""), MessageLevel::error);
     }
   }
+  compactBuffer();
+}
+
+QByteArray NewSerialParser::take(int count) {
+  QByteArray result = buffer.mid(readPos, count);
+  consume(count);
+  return result;
+}
+
+int NewSerialParser::findInBuffer(char ch) const {
+  int index = buffer.indexOf(ch, readPos);
+  return index < 0 ? -1 : index - readPos;
+}
+
+int NewSerialParser::findInBuffer(const char *str) const {
+  int index = buffer.indexOf(str, readPos);
+  return index < 0 ? -1 : index - readPos;
+}
+
+void NewSerialParser::compactBuffer() {
+  // Parsed bytes are only skipped by moving readPos, the data is moved to the beginning of the buffer
+  // only once they make up more than half of it (or dropped at once if everything was parsed).
+  if (readPos >= buffer.length()) {
+    buffer.clear();
+    readPos = 0;
+  } else if (readPos > buffer.length() / 2) {
+    buffer.remove(0, readPos);
+    readPos = 0;
+  }
 }
 
-NewSerialParser::readResult NewSerialParser::bufferReadPoint(QList<QPair<ValueType, QByteArray>> &result) {
-  while (!buffer.isEmpty()) {
+void NewSerialParser::appendPointValue(QList<QPair<ValueType, QByteArray>> &result, SampleBatch *batch, const ValueType &type, const char *data, int length) {
+  if (batch != nullptr)
+    batch->appendField(type, data, length);
+  else
+    result.append(QPair<ValueType, QByteArray>(type, QByteArray(data, length)));
+}
+
+QByteArray NewSerialParser::pointColumnToText(const SampleBatch::Column &column) {
+  if (!column.isValid)
+    return column.invalidText;
+  if (column.count == 0)
+    return QByteArray();
+  return QByteArray::number(pendingPoint->value(column), 'g', 10);
+}
+
+NewSerialParser::readResult NewSerialParser::bufferReadPoint(QList<QPair<ValueType, QByteArray>> &result, SampleBatch *batch) {
+  while (available() > 0) {
     // Text number
-    if (buffer.at(0) == ' ') {
-      buffer.remove(0, 1);
+    if (peek() == ' ') {
+      consume(1);
       continue;
     }
 
-    if (buffer.at(0) == ',') {
-      if (buffer.length() > 1) {
-        if (buffer.at(1) == ',') {
+    if (peek() == ',') {
+      if (available() > 1) {
+        if (peek(1) == ',') {
           ValueType valType(false);
-          result.append(QPair<ValueType, QByteArray>(valType, ""));
+          appendPointValue(result, batch, valType, nullptr, 0);
         }
-        buffer.remove(0, 1);
+        consume(1);
       } else
         return incomplete;
     }
 
     // NaN or Inf
-    if (buffer.at(0) == 'n' || buffer.at(0) == 'N' || buffer.at(0) == 'i' || buffer.at(0) == 'I') {
-      if (buffer.length() == 1)
+    if (peek() == 'n' || peek() == 'N' || peek() == 'i' || peek() == 'I') {
+      if (available() == 1)
         return incomplete;
-      if (buffer.length() == 2 && (buffer.at(1) == 'a' || buffer.at(1) != 'A' || buffer.at(1) == 'n' || buffer.at(1) != 'N'))
+      if (available() == 2 && (peek(1) == 'a' || peek(1) != 'A' || peek(1) == 'n' || peek(1) != 'N'))
         return incomplete;
 
-      if (buffer.left(3).toLower() == "nan") {
+      if (qstrnicmp(readPtr(), "nan", 3) == 0) {
         ValueType valType(false);
-        result.append(QPair<ValueType, QByteArray>(valType, ""));
+        appendPointValue(result, batch, valType, nullptr, 0);
         sendMessageIfAllowed(tr("Received NaN"), tr("Treated as no value"), MessageLevel::warning);
-        buffer.remove(0, 3);
-      } else if (buffer.left(3).toLower() == "inf") {
+        consume(3);
+      } else if (qstrnicmp(readPtr(), "inf", 3) == 0) {
         ValueType valType(false);
-        result.append(QPair<ValueType, QByteArray>(valType, ""));
+        appendPointValue(result, batch, valType, nullptr, 0);
         sendMessageIfAllowed(tr("Received Inf"), tr("Treated as no value"), MessageLevel::warning);
-        buffer.remove(0, 3);
+        consume(3);
       }
 
-      if (buffer.isEmpty())
+      if (available() == 0)
         continue;
-      if (buffer.at(0) == ';') {
-        buffer.remove(0, 1);
+      if (peek() == ';') {
+        consume(1);
         return complete;
       }
-      if (buffer.length() >= 2)
-        if (buffer.left(2) == "$$")
+      if (available() >= 2)
+        if (peek(0) == '$' && peek(1) == '$')
           return notProperlyEnded;
       continue;
     }
 
-    if (IS_NUMERIC_CHAR(buffer.at(0))) {
+    if (IS_NUMERIC_CHAR(peek())) {
       // Look for the nearest character: ',' ';' or '$'
-      // If none is found the function returns -1 which becomes the maximum unsigned value and thus certainly isn't the nearest
+      // Bytes searched by previous (incomplete) calls are not searched again
       ValueType valType(false);
-      unsigned int comma = buffer.indexOf(',');
-      unsigned int semicolon = buffer.indexOf(';');
-      unsigned int dollar = buffer.indexOf('$');
-      if (comma < semicolon && comma < dollar) {
-        // The comma is the nearest
-        QByteArray value = buffer.left(comma);
-        // A single dash means the channel is skipped
-        if (value == "-")
-          value.clear();
-        if (value.toLower() == "-inf") {
-          value.clear();
-          sendMessageIfAllowed(tr("Received -Inf"), tr("Treated as no value"), MessageLevel::warning);
-        }
-        result.append(QPair<ValueType, QByteArray>(valType, value));
-        buffer.remove(0, comma + 1);
+      const char *data = readPtr();
+      const int length = available();
+      int end = scannedLength;
+      while (end < length && data[end] != ',' && data[end] != ';' && data[end] != '$')
+        end++;
+      if (end == length) {
+        // There is no such character, the buffer does not contain the entire value
+        scannedLength = length;
+        return incomplete;
+      }
+      const char ending = data[end];
+      int valueLength = end;
+      // A single dash means the channel is skipped
+      if (valueLength == 1 && data[0] == '-')
+        valueLength = 0;
+      if (valueLength == 4 && qstrnicmp(data, "-inf", 4) == 0) {
+        valueLength = 0;
+        sendMessageIfAllowed(tr("Received -Inf"), tr("Treated as no value"), MessageLevel::warning);
+      }
+      appendPointValue(result, batch, valType, data, valueLength);
+      if (ending == ',') {
+        consume(end + 1);
         continue;
-      } else if (semicolon < comma && semicolon < dollar) {
-        QByteArray value = buffer.left(semicolon);
-        if (value == "-")
-          value.clear();
-        if (value.toLower() == "-inf") {
-          value.clear();
-          sendMessageIfAllowed(tr("Received -Inf"), tr("Treated as no value"), MessageLevel::warning);
-        }
-        result.append(QPair<ValueType, QByteArray>(valType, value));
-        buffer.remove(0, semicolon + 1);
+      }
+      if (ending == ';') {
+        consume(end + 1);
         return complete;
-      } else if (dollar < comma && dollar < semicolon) {
-        QByteArray value = buffer.left(dollar);
-        if (value == "-")
-          value.clear();
-        if (value.toLower() == "-inf") {
-          value.clear();
-          sendMessageIfAllowed(tr("Received -Inf"), tr("Treated as no value"), MessageLevel::warning);
-        }
-        result.append(QPair<ValueType, QByteArray>(valType, value));
-        buffer.remove(0, dollar);
-        return notProperlyEnded;
-      } else
-        // None is smaller (they are equal and at maximum, so there is no such character)
-        return incomplete;
+      }
+      consume(end);
+      return notProperlyEnded;
     } else {
-      if (buffer.length() == 1) {
-        if (buffer.at(0) == ';') {
+      if (available() == 1) {
+        if (peek() == ';') {
           // End of point
-          buffer.remove(0, 1);
+          consume(1);
           return complete;
         } else
           // The buffer does not contain the entire point
@@ -716,23 +765,23 @@ NewSerialParser::readResult NewSerialParser::bufferReadPoint(QList<QPair<ValueTy
 
       // Binary data
       int prefixLength = 0;
-      ValueType valType = readValuePrefix(buffer, prefixLength);
+      ValueType valType = readValuePrefix(readPtr(), available(), prefixLength);
       if (valType.type == ValueType::Type::invalid) {
-        throw(tr("Expected value, but \"%1\" found.").arg(QString(buffer.left(prefixLength))));
+        throw(tr("Expected value, but \"%1\" found.").arg(QString(buffer.mid(readPos, prefixLength))));
       }
-      if (buffer.length() < valType.bytes + prefixLength || valType.type == ValueType::Type::incomplete)
+      if (available() < valType.bytes + prefixLength || valType.type == ValueType::Type::incomplete)
         return incomplete;
-      buffer.remove(0, prefixLength);
-      result.append(QPair<ValueType, QByteArray>(valType, buffer.left(valType.bytes)));
-      buffer.remove(0, valType.bytes);
-      if (buffer.isEmpty())
+      consume(prefixLength);
+      appendPointValue(result, batch, valType, readPtr(), valType.bytes);
+      consume(valType.bytes);
+      if (available() == 0)
         continue;
-      if (buffer.at(0) == ';') {
-        buffer.remove(0, 1);
+      if (peek() == ';') {
+        consume(1);
         return complete;
       }
-      if (buffer.length() >= 2)
-        if (buffer.left(2) == "$$")
+      if (available() >= 2)
+        if (peek(0) == '$' && peek(1) == '$')
           return notProperlyEnded;
       continue;
     }
@@ -833,67 +882,69 @@ void NewSerialParser::parseMode(QChar modeChar) {
     pendingDataBuffer.clear();
   if (!pendingPointBuffer.isEmpty())
     pendingPointBuffer.clear();
+  pendingPoint.reset();
   resetChHeader();
 }
 
 NewSerialParser::readResult NewSerialParser::bufferPullFull(QByteArray &result) {
-  if (buffer.contains("$$")) {
-    result.push_back(buffer.left(buffer.indexOf("$$")));
-    buffer.remove(0, buffer.indexOf("$$"));
+  int end = findInBuffer("$$");
+  if (end >= 0) {
+    result.push_back(take(end));
     return complete;
   } else {
-    if (buffer.at(buffer.length() - 1) == '$') {
-      result.push_back(buffer.left(buffer.length() - 1));
-      buffer.remove(0, buffer.length() - 1);
-    } else {
-      result.push_back(buffer);
-      buffer.clear();
-    }
+    if (peek(available() - 1) == '$')
+      result.push_back(take(available() - 1));
+    else
+      result.push_back(take(available()));
     return incomplete;
   }
 }
 
 NewSerialParser::readResult NewSerialParser::bufferPullBeforeSemicolon(QByteArray &result, bool removeNewline) {
-  int end;
+  // Find whichever comes first, ';' or "$$"
+  // Bytes searched by previous (incomplete) calls are not searched again
+  const char *data = readPtr();
+  const int length = available();
+  int end = scannedLength;
   delimiter ending = none;
-  if (buffer.contains(';')) {
-    ending = semicolon;
-    end = buffer.indexOf(';');
-  }
-  if (buffer.contains("$$")) {
-    int newEnd = buffer.indexOf("$$");
-    if (ending == none || newEnd < end) {
-      end = newEnd;
+  for (; end < length; end++) {
+    if (data[end] == ';') {
+      ending = semicolon;
+      break;
+    }
+    if (data[end] == '$' && end + 1 < length && data[end + 1] == '$') {
       ending = dollar;
+      break;
     }
   }
-  if (ending == none)
+  if (ending == none) {
+    // The last byte can be first half of "$$"
+    scannedLength = MAX(length - 1, 0);
     return incomplete;
-  result.push_back(buffer.left(end));
+  }
+  result.push_back(take(end));
   if (ending == semicolon) {
-    buffer.remove(0, end + 1);
-    if (removeNewline && !buffer.isEmpty())
-      if (buffer.at(0) == '\n')
-        buffer.remove(0, 1);
+    consume(1);
+    if (removeNewline && available() > 0)
+      if (peek() == '\n')
+        consume(1);
     return complete;
   }
-  buffer.remove(0, end);
   return notProperlyEnded;
 }
 
 NewSerialParser::readResult NewSerialParser::bufferPullBeforeNull(QByteArray &result) {
-  int end;
-  bool ended = false;
-  if (buffer.contains('\0')) {
-    ended = true;
-    end = buffer.indexOf('\0');
-  }
+  const char *data = readPtr();
+  const int length = available();
+  const char *terminator = (const char *)memchr(data + scannedLength, '\0', length - scannedLength);
 
-  if (!ended)
+  if (terminator == nullptr) {
+    scannedLength = length;
     return incomplete;
+  }
 
-  result.push_back(buffer.left(end));
-  buffer.remove(0, end + 1);
+  result.push_back(take(terminator - data));
+  consume(1);
   return complete;
 }
 
@@ -910,22 +961,21 @@ void NewSerialParser::printUnknownToTerminalTimerSlot() {
 
 NewSerialParser::readResult NewSerialParser::bufferPullChannel(QPair<ValueType, QByteArray> &result) {
   int prefixLength = 0;
-  ValueType valType = readValuePrefix(buffer, prefixLength);
+  ValueType valType = readValuePrefix(readPtr(), available(), prefixLength);
 
   if (valType.type == ValueType::Type::invalid)
-    throw(tr("Invalid value type: %1").arg(QString(buffer.left(prefixLength))));
+    throw(tr("Invalid value type: %1").arg(QString(buffer.mid(readPos, prefixLength))));
   if (valType.type == ValueType::Type::incomplete)
     return incomplete;
 
-  if ((uint32_t)buffer.length() < channelLength * valType.bytes + prefixLength + 1)
+  if ((uint32_t)available() < channelLength * valType.bytes + prefixLength + 1)
     return incomplete;
 
-  buffer.remove(0, prefixLength);
-  result = QPair<ValueType, QByteArray>(valType, buffer.left(channelLength * valType.bytes));
-  buffer.remove(0, channelLength * valType.bytes);
-  if (buffer.at(0) != ';')
+  consume(prefixLength);
+  result = QPair<ValueType, QByteArray>(valType, take(channelLength * valType.bytes));
+  if (peek() != ';')
     return notProperlyEnded;
-  buffer.remove(0, 1);
+  consume(1);
   return complete;
 }
 
@@ -17,6 +17,7 @@
 #define NEWSERIALPARSER_H
 
 #include "global.h"
+#include "samplebatch.h"
 #include <QDebug>
 #include <QObject>
 #include <QThread>
@@ -43,11 +44,11 @@ signals:
   /// Sends a file request
   void sendFileRequest(QByteArray message, MessageTarget::enumMessageTarget source);
   /// Sends a point for processing
-  void sendPoint(QList<QPair<ValueType, QByteArray>> data);
+  void sendPoint(QSharedPointer<SampleBatch> data);
   /// Sends a logic point for processing
   void sendLogicPoint(QPair<ValueType, QByteArray> timeArray, QPair<ValueType, QByteArray> valueArray, unsigned int bits);
-  /// Sends a channel for processing
-  void sendChannel(QPair<ValueType, QByteArray> data, unsigned int ch, QPair<ValueType, QByteArray> timeRaw, int zeroIndex, int bits, QPair<ValueType, QByteArray> min, QPair<ValueType, QByteArray> max);
+  /// Sends a channel (or several interleaved channels) for processing
+  void sendChannel(QSharedPointer<SampleBatch> data);
   /// Sends a logic channel for processing
   void sendLogicChannel(QPair<ValueType, QByteArray> data, QPair<ValueType, QByteArray> timeRaw, int bits, int zeroIndex);
   /// Confirms readiness
@@ -84,13 +85,32 @@ private:
   QByteArray printUnknownToTerminalBuffer;
   QTimer *printUnknownToTerminalTimer = nullptr;
   QByteArray buffer;
+  /// Position of the first unprocessed byte in buffer (bytes before it are already parsed)
+  int readPos = 0;
+  /// Number of unprocessed bytes already searched for a delimiter without success
+  int scannedLength = 0;
+  int available() const { return buffer.length() - readPos; }
+  char peek(int offset = 0) const { return buffer.at(readPos + offset); }
+  const char *readPtr() const { return buffer.constData() + readPos; }
+  void consume(int count) {
+    readPos += count;
+    scannedLength = 0;
+  }
+  QByteArray take(int count);
+  int findInBuffer(char ch) const;
+  int findInBuffer(const char *str) const;
+  void compactBuffer();
   QByteArray pendingDataBuffer;
   QList<QPair<ValueType, QByteArray>> pendingPointBuffer;
+  /// Point being received in point mode (other modes use pendingPointBuffer)
+  QSharedPointer<SampleBatch> pendingPoint;
+  void appendPointValue(QList<QPair<ValueType, QByteArray>> &result, SampleBatch *batch, const ValueType &type, const char *data, int length);
+  QByteArray pointColumnToText(const SampleBatch::Column &column);
   void parseMode(QChar modeChar);
   readResult bufferPullFull(QByteArray &result);
   void changeMode(DataMode::enumDataMode mode, DataMode::enumDataMode previousMode, QByteArray modeName);
   readResult bufferPullBeforeSemicolon(QByteArray &result, bool removeNewline = false);
-  readResult bufferReadPoint(QList<QPair<ValueType, QByteArray>> &result);
+  readResult bufferReadPoint(QList<QPair<ValueType, QByteArray>> &result, SampleBatch *batch = nullptr);
   uint32_t arrayToUint(QPair<ValueType, QByteArray> value);
   readResult bufferPullChannel(QPair<ValueType, QByteArray> &result);
   bool replyToEcho = true;
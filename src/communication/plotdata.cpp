@@ -24,6 +24,13 @@ PlotData::PlotData(QObject *parent) : QObject(parent) {
     mathFirsts[i] = 0;
     mathSeconds[i] = 0;
   }
+  pendingPlotPoints.resize(ALL_COUNT);
+  pendingPlotPointsAppend.resize(ALL_COUNT);
+  pointBatchTimer = new QTimer(this);
+  pointBatchTimer->setSingleShot(true);
+  pointBatchTimer->setInterval(POINT_BATCH_INTERVAL);
+  connect(pointBatchTimer, &QTimer::timeout, this, &PlotData::flushPointsToPlot);
+
   reset();
 
   updatesCounter = new QTimer(this);
@@ -34,6 +41,98 @@ PlotData::PlotData(QObject *parent) : QObject(parent) {
 PlotData::~PlotData() {
   updatesCounter->stop();
   delete updatesCounter;
+  pointBatchTimer->stop();
+  delete pointBatchTimer;
+}
+
+void PlotData::queuePointToPlot(int chID, double time, double value, bool append) {
+  QSharedPointer<QCPGraphDataContainer> &points = pendingPlotPoints[chID];
+  if (points.isNull() || !append) {
+    // Point that is not appended clears the channel, so points collected before it are not plotted (but still logged)
+    if (!points.isNull())
+      emit pointsNotPlotted(chID, points);
+    points.reset(new QCPGraphDataContainer);
+    pendingPlotPointsAppend[chID] = append;
+  }
+  points->add(QCPGraphData(time, value));
+  if (points->size() >= POINT_BATCH_MAX_SIZE)
+    flushChannelPointsToPlot(chID);
+  else if (!pointBatchTimer->isActive())
+    pointBatchTimer->start();
+}
+
+void PlotData::flushChannelPointsToPlot(int chID) {
+  if (pendingPlotPoints.at(chID).isNull())
+    return;
+  emit addPointsToPlot(chID, pendingPlotPoints.at(chID), pendingPlotPointsAppend.at(chID));
+  pendingPlotPoints[chID].reset();
+}
+
+void PlotData::flushPointsToPlot() {
+  pointBatchTimer->stop();
+  for (int chID = 0; chID < pendingPlotPoints.size(); chID++)
+    flushChannelPointsToPlot(chID);
+}
+
+/// Transposes a 32x32 bit matrix in place (bit c of word r is swapped with bit r of word c)
+static void transposeBits32(uint32_t words[32]) {
+  uint32_t mask = 0x0000FFFF;
+  for (int width = 16; width != 0; width >>= 1, mask ^= (mask << width)) {
+    for (int k = 0; k < 32; k = (k + width + 1) & ~width) {
+      uint32_t swap = ((words[k] >> width) ^ words[k + width]) & mask;
+      words[k] ^= swap << width;
+      words[k + width] ^= swap;
+    }
+  }
+}
+
+QVector<QSharedPointer<QCPGraphDataContainer>> PlotData::splitLogicBits(const double *samples, int count, double timeStep, int zeroIndex, int bits) {
+  bits = qBound(0, bits, LOGIC_BITS);
+  uint32_t mask = bits == 32 ? 0xFFFFFFFF : (((uint32_t)1 << bits) - 1);
+
+  // Only the samples around a change of the group value (last one before and first one after) are kept,
+  // together with the first and last sample. All bits share the same samples, so sample indices
+  // (cursors, export) stay common for the group, and lines look the same as with all samples.
+  QVector<uint32_t> words(count);
+  QVector<double> keys(count);
+  int kept = 0;
+  for (int i = 0; i < count; i++) {
+    uint32_t word = (uint32_t)samples[i] & mask;
+    if (logicTransitionsOnly && i > 0 && i < count - 1 && word == words.at(kept - 1) && word == ((uint32_t)samples[i + 1] & mask))
+      continue;
+    words[kept] = word;
+    keys[kept] = (i - zeroIndex) * timeStep;
+    kept++;
+  }
+
+  QVector<QVector<QCPGraphData>> planes(bits);
+  for (int bit = 0; bit < bits; bit++)
+    planes[bit].resize(kept);
+
+  // Blocks of 32 samples are transposed, so that each word holds one bit of 32 consecutive samples.
+  // Every bit channel is then written sequentially instead of 32 channels being appended sample by sample.
+  uint32_t block[32];
+  for (int first = 0; first < kept; first += 32) {
+    int blockLength = MIN(32, kept - first);
+    for (int i = 0; i < 32; i++)
+      block[i] = i < blockLength ? words.at(first + i) : 0;
+    transposeBits32(block);
+    for (int bit = 0; bit < bits; bit++) {
+      QCPGraphData *out = planes[bit].data() + first;
+      uint32_t plane = block[bit];
+      for (int i = 0; i < blockLength; i++) {
+        out[i].key = keys.at(first + i);
+        out[i].value = ((plane >> i) & 1) + bit * 3;
+      }
+    }
+  }
+
+  QVector<QSharedPointer<QCPGraphDataContainer>> digitalChannels;
+  for (int bit = 0; bit < bits; bit++) {
+    digitalChannels.append(QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer));
+    digitalChannels.last()->set(planes.at(bit), timeStep >= 0);
+  }
+  return digitalChannels;
 }
 
 double PlotData::getValue(QPair<ValueType, QByteArray> value, bool &isok) {
@@ -150,16 +249,16 @@ uint32_t PlotData::getBits(QPair<ValueType, QByteArray> value) {
   return 0;
 }
 
-void PlotData::addPoint(QList<QPair<ValueType, QByteArray>> data) {
+void PlotData::addPoint(QSharedPointer<SampleBatch> data) {
   QString message;
-  if (data.length() > ANALOG_COUNT) {
-    QByteArray message = QString::number(data.length() - 1).toUtf8();
+  const QVector<SampleBatch::Column> &columns = data->columns;
+  if (columns.length() > ANALOG_COUNT) {
+    QByteArray message = QString::number(columns.length() - 1).toUtf8();
     sendMessageIfAllowed(tr("Too many channels in point (missing ';' ?)").toUtf8(), message, MessageLevel::error);
     return;
   }
-  bool isok;
   double time;
-  if (data.at(0).second.isEmpty()) {
+  if (data->timeSource == SampleBatch::timeImplicit) {
     if (qIsInf(lastTime))
       time = 0;
     else
@@ -167,11 +266,11 @@ void PlotData::addPoint(QList<QPair<ValueType, QByteArray>> data) {
 
     if (debugLevel == OutputLevel::info)
       message.append(tr("Index (time): %1, ").arg(QString::number(time, 'g', 5)));
-  } else if (data.at(0).second == "-tod") {
+  } else if (data->timeSource == SampleBatch::timeOfDay) {
     time = qTime.currentTime().msecsSinceStartOfDay() / 1000.0;
     if (debugLevel == OutputLevel::info)
       message.append(tr("Time (time of day): %1 s, ").arg(QString::number(time, 'g', 5)));
-  } else if (data.at(0).second == "-auto") {
+  } else if (data->timeSource == SampleBatch::timeAutomatic) {
     if (!timerRunning) {
       elapsedTime.start();
       timerRunning = 1;
@@ -180,32 +279,33 @@ void PlotData::addPoint(QList<QPair<ValueType, QByteArray>> data) {
     if (debugLevel == OutputLevel::info)
       message.append(tr("Time (automatic): %1 s, ").arg(QString::number(time, 'g', 5)));
   } else {
-    time = getValue(data.at(0), isok);
-    if (!isok) {
-      sendMessageIfAllowed(tr("Can not parse point time").toUtf8(), data.at(0).second, MessageLevel::error);
+    if (!data->hasValue(columns.at(0))) {
+      sendMessageIfAllowed(tr("Can not parse point time").toUtf8(), columns.at(0).invalidText, MessageLevel::error);
       return;
     }
+    time = data->value(columns.at(0));
     if (debugLevel == OutputLevel::info)
       message.append(tr("Time: %1 s, ").arg(QString::number(time, 'g', 5)));
   }
-  for (unsigned int ch = 1; (int)ch < data.length(); ch++) {
-    if (data.at(ch).second.isEmpty())
+  for (unsigned int ch = 1; (int)ch < columns.length(); ch++) {
+    const SampleBatch::Column &column = columns.at(ch);
+    if (column.isValid && !data->hasValue(column))
       continue;
-    double value = getValue(data.at(ch), isok);
-    if (!isok) {
-      sendMessageIfAllowed(tr("Can not parse points value").toUtf8(), data.at(ch).second, MessageLevel::error);
+    if (!column.isValid) {
+      sendMessageIfAllowed(tr("Can not parse points value").toUtf8(), column.invalidText, MessageLevel::error);
       return;
     }
+    double value = data->value(column);
 
     bool isLogic = false;
     for (int i = 0; i < LOGIC_GROUPS - 1; i++)
       if (logicTargets[i] == ch)
         isLogic = true;
     if (isLogic) {
-      if (data.at(ch).first.type == ValueType::Type::unsignedint) {
-        unsigned int bits = 8 * data.at(ch).first.bytes;
+      if (column.type.type == ValueType::Type::unsignedint) {
+        unsigned int bits = 8 * column.type.bytes;
         QVector<double> digitalChannels;
-        uint32_t digitalValue = getBits(data.at(ch));
+        uint32_t digitalValue = data->bitsOf(column);
         for (uint8_t bit = 0; bit < bits; bit++)
           digitalChannels.append((((bool)((digitalValue) & ((uint32_t)1 << (bit)))) + bit * 3));
         for (int logicGroup = 0; logicGroup < LOGIC_GROUPS - 1; logicGroup++) {
@@ -214,7 +314,7 @@ void PlotData::addPoint(QList<QPair<ValueType, QByteArray>> data) {
           if (logicBits[ch - 1] > 0 && logicBits[ch - 1] < bits)
             bits = logicBits[ch - 1];
           for (uint8_t bit = 0; bit < bits; bit++) {
-            emit addPointToPlot(getLogicChannelID(logicGroup, bit), time, digitalChannels.at(bit), time >= lastTime);
+            queuePointToPlot(getLogicChannelID(logicGroup, bit), time, digitalChannels.at(bit), time >= lastTime);
           }
         }
       } else {
@@ -229,7 +329,7 @@ void PlotData::addPoint(QList<QPair<ValueType, QByteArray>> data) {
     if (averagerEnabled)
       emit addPointToAverager(ch - 1, time, value, time >= lastTime);
     else
-      emit addPointToPlot(ch - 1, time, value, time >= lastTime);
+      queuePointToPlot(ch - 1, time, value, time >= lastTime);
 
     if (debugLevel == OutputLevel::info)
       message.append(tr("Ch%1: %2, ").arg(ch).arg(QString::number(value, 'g', 5)));
@@ -245,6 +345,12 @@ void PlotData::addPoint(QList<QPair<ValueType, QByteArray>> data) {
         point->add(QCPGraphData(time, value));
         emit addMathData(math, false, point);
       }
+      int input = mathExpressionInputs[math].indexOf(ch);
+      if (input >= 0) {
+        auto point = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer());
+        point->add(QCPGraphData(time, value));
+        emit addMathExpressionData(math, input, point);
+      }
     }
   }
   lastTime = time;
@@ -282,7 +388,7 @@ void PlotData::addLogicPoint(QPair<ValueType, QByteArray> timeArray, QPair<Value
     uint32_t digitalValue = getBits(valueArray);
     for (uint8_t bit = 0; bit < bits; bit++) {
       double value = ((bool)((digitalValue) & ((uint32_t)1 << (bit)))) + bit * 3;
-      emit addPointToPlot(getLogicChannelID(2, bit), time, value, time >= lastTime);
+      queuePointToPlot(getLogicChannelID(2, bit), time, value, time >= lastTime);
     }
 
     updatesCounters[-1]++;
@@ -294,116 +400,120 @@ void PlotData::addLogicPoint(QPair<ValueType, QByteArray> timeArray, QPair<Value
   lastTime = time;
 }
 
-void PlotData::addChannel(QPair<ValueType, QByteArray> data, unsigned int ch, QPair<ValueType, QByteArray> timeRaw, int zeroIndex, int bits, QPair<ValueType, QByteArray> min, QPair<ValueType, QByteArray> max) {
-  // Determine input data type
-  // QByteArray typeID, numberBytes;
-
+void PlotData::addChannel(QSharedPointer<SampleBatch> data) {
   // Convert the time interval to a number
-  bool isok;
-  double timeStep = getValue(timeRaw, isok);
-  if (!isok) {
-    sendMessageIfAllowed(tr("Can not parse channel time step").toUtf8(), timeRaw.second, MessageLevel::error);
+  if (!data->hasValue(data->timeStep)) {
+    sendMessageIfAllowed(tr("Can not parse channel time step").toUtf8(), data->timeStep.invalidText, MessageLevel::error);
     return;
   }
+  double timeStep = data->value(data->timeStep);
 
   // Perform remapping only if max is specified
-  bool remap = !max.second.isEmpty();
+  bool remap = data->hasValue(data->maximum) || !data->maximum.isValid;
+  bool minimumStated = data->hasValue(data->minimum) || !data->minimum.isValid;
 
   // Convert the minimum value to a number
   double minimum = 0;
-  if (!min.second.isEmpty()) {
+  if (minimumStated) {
     if (!remap)
       sendMessageIfAllowed(tr("Minimum value is stated, but maximum is not").toUtf8(), tr("Value will not be remapped!").toUtf8(), MessageLevel::warning);
-    minimum = getValue(min, isok);
-    if (!isok) {
-      sendMessageIfAllowed(tr("Can not parse minimum value").toUtf8(), min.second, MessageLevel::error);
+    if (!data->hasValue(data->minimum)) {
+      sendMessageIfAllowed(tr("Can not parse minimum value").toUtf8(), data->minimum.invalidText, MessageLevel::error);
       return;
     }
+    minimum = data->value(data->minimum);
   }
 
   // Convert the maximum value to a number
   double maximum = 0;
-  if (remap || !min.second.isEmpty()) {
-    maximum = getValue(max, isok);
-    if (!isok) {
-      sendMessageIfAllowed(tr("Can not parse maximum value").toUtf8(), max.second, MessageLevel::error);
+  if (remap || minimumStated) {
+    if (!data->hasValue(data->maximum)) {
+      sendMessageIfAllowed(tr("Can not parse maximum value").toUtf8(), data->maximum.invalidText, MessageLevel::error);
       return;
     }
+    maximum = data->value(data->maximum);
   }
 
-  // Information about the received channel
-  if (debugLevel == OutputLevel::info) {
-    QByteArray message = tr("%1 samples, sampling period %2s").arg(data.second.length() / data.first.bytes).arg(floatToNiceString(timeStep, 4, false, false)).toUtf8();
-    message.append(tr(", %n bit(s)", "", bits).toUtf8());
+  // Points received before the channel must not end up after it
+  flushPointsToPlot();
+
+  // Interleaved channels are in separate columns
+  for (const SampleBatch::Column &column : data->columns) {
+    unsigned int ch = column.channel;
+    int bits = data->bits;
+    int zeroIndex = data->zeroIndex;
+
+    // Information about the received channel
+    if (debugLevel == OutputLevel::info) {
+      QByteArray message = tr("%1 samples, sampling period %2s").arg(column.count).arg(floatToNiceString(timeStep, 4, false, false)).toUtf8();
+      message.append(tr(", %n bit(s)", "", bits).toUtf8());
+      if (remap)
+        message.append(tr(", from %1 to %2").arg(minimum).arg(maximum).toUtf8());
+      if (zeroIndex > 0)
+        message.append(tr(", zero time at sample index %3").arg(zeroIndex).toUtf8());
+      emit sendMessage(tr("Parsed channel %1").arg(ch).toUtf8(), message, MessageLevel::info);
+    }
+
+    bool isLogic = false;
+    for (int i = 0; i < LOGIC_GROUPS - 1; i++)
+      if (logicTargets[i] == ch)
+        isLogic = true;
+    if (isLogic && column.type.type != ValueType::Type::unsignedint) {
+      isLogic = false;
+      sendMessageIfAllowed(tr("Can not show channel %1 as logic").arg(ch), tr("digital mode is only available for unsigned integer data type").toUtf8(), MessageLevel::warning);
+    }
+
+    double multiplier = column.type.multiplier;
     if (remap)
-      message.append(tr(", from %1 to %2").arg(minimum).arg(maximum).toUtf8());
-    if (zeroIndex > 0)
-      message.append(tr(", zero time at sample index %3").arg(zeroIndex).toUtf8());
-    emit sendMessage(tr("Parsed channel %1").arg(ch).toUtf8(), message, MessageLevel::info);
-  }
+      multiplier *= (maximum - minimum) / (1 << bits);
+
+    // Vectors are passed as pointers; the plot will delete them after processing.
+    // Points are written into a preallocated vector, which the container then takes over without copying.
+    const double *samples = data->values.constData() + column.offset;
+    QVector<QCPGraphData> points(column.count);
+    QCPGraphData *point = points.data();
+    for (int i = 0; i < column.count; i++) {
+      point[i].key = (i - zeroIndex) * timeStep;
+      point[i].value = minimum + samples[i] * multiplier;
+    }
+    auto analogData = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
+    analogData->set(points, timeStep >= 0);
 
-  bool isLogic = false;
-  for (int i = 0; i < LOGIC_GROUPS - 1; i++)
-    if (logicTargets[i] == ch)
-      isLogic = true;
-  if (isLogic && data.first.type != ValueType::Type::unsignedint) {
-    isLogic = false;
-    sendMessageIfAllowed(tr("Can not show channel %1 as logic").arg(ch), tr("digital mode is only available for unsigned integer data type").toUtf8(), MessageLevel::warning);
-  }
+    // Send the channel to the plot and possibly to calculations
+    for (int math = 0; math < MATH_COUNT; math++) {
+      if (mathFirsts[math] == ch)
+        emit addMathData(math, true, analogData);
+      if (mathSeconds[math] == ch)
+        emit addMathData(math, false, analogData);
+      int input = mathExpressionInputs[math].indexOf(ch);
+      if (input >= 0)
+        emit addMathExpressionData(math, input, analogData);
+    }
 
-  if (remap)
-    data.first.multiplier *= (maximum - minimum) / (1 << bits);
-
-  // Vectors are passed as pointers; the plot will delete them after processing.
-  auto analogData = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
-  QVector<double> times;
-  QVector<uint32_t> valuesDigital;
-  QCPGraphData point;
-  for (int i = 0; i < data.second.length(); i += data.first.bytes) {
-    times.append(((i / data.first.bytes) - zeroIndex) * timeStep);
-    point.key = times.last();
-    point.value = minimum + getValue(QPair<ValueType, QByteArray>(data.first, data.second.mid(i, data.first.bytes)), isok);
-    if (isLogic)
-      valuesDigital.append(getBits(QPair<ValueType, QByteArray>(data.first, data.second.mid(i, data.first.bytes))));
-    analogData->add(point);
-  }
+    if (remap)
+      emit setExpectedRange(ch - 1, true, minimum, maximum);
+    else
+      emit setExpectedRange(ch - 1, false, 0, 0);
 
-  // Send the channel to the plot and possibly to calculations
-  for (int math = 0; math < MATH_COUNT; math++) {
-    if (mathFirsts[math] == ch)
-      emit addMathData(math, true, analogData);
-    if (mathSeconds[math] == ch)
-      emit addMathData(math, false, analogData);
-  }
+    updatesCounters[ch]++;
 
-  if (remap)
-    emit setExpectedRange(ch - 1, true, minimum, maximum);
-  else
-    emit setExpectedRange(ch - 1, false, 0, 0);
+    if (averagerEnabled)
+      emit addDataToAverager(ch - 1, timeStep, analogData);
+    else
+      emit addVectorToPlot(ch - 1, analogData);
 
-  updatesCounters[ch]++;
-
-  if (averagerEnabled)
-    emit addDataToAverager(ch - 1, timeStep, analogData);
-  else
-    emit addVectorToPlot(ch - 1, analogData);
-
-  if (isLogic) {
-    // Send a logic channel to the plot
-    QVector<QSharedPointer<QCPGraphDataContainer>> digitalChannels;
-    for (uint8_t bit = 0; bit < bits; bit++)
-      digitalChannels.append(QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer));
-    for (int i = 0; i < valuesDigital.length(); i++)
-      for (uint8_t bit = 0; bit < bits; bit++)
-        digitalChannels.at(bit)->add(QCPGraphData(times.at(i), ((bool)((valuesDigital.at(i)) & ((uint32_t)1 << (bit)))) + bit * 3));
-
-    for (int logicGroup = 0; logicGroup < LOGIC_GROUPS - 1; logicGroup++) {
-      if (logicTargets[logicGroup] != ch)
-        continue;
-      if (logicBits[ch - 1] > 0 && logicBits[ch - 1] < (unsigned int)bits)
-        bits = logicBits[ch - 1];
-      for (uint8_t bit = 0; bit < bits; bit++) {
-        emit addVectorToPlot(getLogicChannelID(logicGroup, bit), digitalChannels.at(bit));
+    if (isLogic) {
+      // Send a logic channel to the plot
+      QVector<QSharedPointer<QCPGraphDataContainer>> digitalChannels = splitLogicBits(samples, column.count, timeStep, zeroIndex, bits);
+
+      for (int logicGroup = 0; logicGroup < LOGIC_GROUPS - 1; logicGroup++) {
+        if (logicTargets[logicGroup] != ch)
+          continue;
+        if (logicBits[ch - 1] > 0 && logicBits[ch - 1] < (unsigned int)bits)
+          bits = logicBits[ch - 1];
+        for (int bit = 0; bit < bits && bit < digitalChannels.size(); bit++) {
+          emit addVectorToPlot(getLogicChannelID(logicGroup, bit), digitalChannels.at(bit));
+        }
       }
     }
   }
@@ -427,39 +537,44 @@ void PlotData::addLogicChannel(QPair<ValueType, QByteArray> data, QPair<ValueTyp
     emit sendMessage(tr("Parsed logic channel").toUtf8(), message, MessageLevel::info);
   }
 
-  QVector<double> times;
-  QVector<uint32_t> valuesDigital;
-  for (int i = 0; i < data.second.length(); i += data.first.bytes) {
-    times.append(((i / data.first.bytes) - zeroIndex) * timeStep);
-    valuesDigital.append(getBits(QPair<ValueType, QByteArray>(data.first, data.second.mid(i, data.first.bytes))));
-  }
+  // Values are taken as raw bits regardless of the stated type (same as getBits)
+  ValueType rawType = data.first;
+  rawType.type = ValueType::Type::unsignedint;
+  QVector<double> valuesDigital(data.first.bytes > 0 ? data.second.length() / data.first.bytes : 0);
+  SampleBatch::decodeBinaryArray(rawType, data.second.constData(), valuesDigital.size(), rawType.bytes, valuesDigital.data());
 
   updatesCounters[-1]++;
 
+  flushPointsToPlot();
+
   // Send a logic channel to the plot
-  QVector<QSharedPointer<QCPGraphDataContainer>> digitalChannels;
-  for (uint8_t bit = 0; bit < bits; bit++)
-    digitalChannels.append(QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer));
-  for (int i = 0; i < valuesDigital.length(); i++)
-    for (uint8_t bit = 0; bit < bits; bit++)
-      digitalChannels.at(bit)->add(QCPGraphData(times.at(i), ((bool)((valuesDigital.at(i)) & ((uint32_t)1 << (bit)))) + bit * 3));
+  QVector<QSharedPointer<QCPGraphDataContainer>> digitalChannels = splitLogicBits(valuesDigital.constData(), valuesDigital.size(), timeStep, zeroIndex, bits);
 
-  for (uint8_t bit = 0; bit < bits; bit++)
+  for (int bit = 0; bit < digitalChannels.size(); bit++)
     emit addVectorToPlot(getLogicChannelID(LOGIC_GROUPS - 1, bit),
                          digitalChannels.at(bit)); // Sent as the last logic group
 }
 
 void PlotData::reset() {
+  // Points waiting for the plot are not plotted (channels are being cleared), but they are still logged
+  pointBatchTimer->stop();
+  for (int chID = 0; chID < pendingPlotPoints.size(); chID++) {
+    if (!pendingPlotPoints.at(chID).isNull())
+      emit pointsNotPlotted(chID, pendingPlotPoints.at(chID));
+    pendingPlotPoints[chID].reset();
+  }
   lastTime = INFINITY;
   timerRunning = false;
 }
 
 void PlotData::setDigitalChannel(int logicGroup, int ch) {
+  flushPointsToPlot();
   logicTargets[logicGroup - 1] = ch;
   emit clearLogic(logicGroup - 1, 0);
 }
 
 void PlotData::setLogicBits(int target, int bits) {
+  flushPointsToPlot();
   logicBits[target - 1] = bits;
   emit clearLogic(target - 1, bits);
 }
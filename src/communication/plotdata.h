@@ -27,6 +27,7 @@
 
 #include "global.h"
 #include "plots/qcustomplot.h"
+#include "samplebatch.h"
 
 class PlotData : public QObject {
   Q_OBJECT
@@ -49,8 +50,19 @@ private:
   unsigned int logicBits[LOGIC_GROUPS - 1];
   unsigned int mathFirsts[MATH_COUNT];
   unsigned int mathSeconds[MATH_COUNT];
+  /// Channels used by the formula of each math channel (position in the list is the input number)
+  QList<int> mathExpressionInputs[MATH_COUNT];
 
   bool averagerEnabled = false;
+  /// Logic frames keep only samples around changes of the group value (exports and cursors then lose the sample grid, so off by default)
+  bool logicTransitionsOnly = false;
+
+  /// Points waiting to be sent to the plot in one block (index is channel ID)
+  QVector<QSharedPointer<QCPGraphDataContainer>> pendingPlotPoints;
+  QVector<bool> pendingPlotPointsAppend;
+  QTimer *pointBatchTimer;
+  void queuePointToPlot(int chID, double time, double value, bool append);
+  void flushChannelPointsToPlot(int chID);
 
   // unsigned int xyFirst, xySecond;
   double getValue(QPair<ValueType, QByteArray> value, bool &isok);
@@ -59,12 +71,15 @@ private:
   double defaultTimestep = 1;
   void sendMessageIfAllowed(QString header, QByteArray message, MessageLevel::enumMessageLevel type);
   uint32_t getBits(QPair<ValueType, QByteArray> value);
+  /// Splits logic samples (raw unsigned values) into one container per bit (value = bit + 3 * bit index).
+  /// With logicTransitionsOnly, samples where the group value does not change are left out.
+  QVector<QSharedPointer<QCPGraphDataContainer>> splitLogicBits(const double *samples, int count, double timeStep, int zeroIndex, int bits);
   double unitToMultiple(char unit);
 
 public slots:
-  void addPoint(QList<QPair<ValueType, QByteArray>> data);
+  void addPoint(QSharedPointer<SampleBatch> data);
   void addLogicPoint(QPair<ValueType, QByteArray> timeArray, QPair<ValueType, QByteArray> valueArray, unsigned int bits);
-  void addChannel(QPair<ValueType, QByteArray> data, unsigned int ch, QPair<ValueType, QByteArray> timeRaw, int zeroIndex, int bits, QPair<ValueType, QByteArray> min, QPair<ValueType, QByteArray> max);
+  void addChannel(QSharedPointer<SampleBatch> data);
   void addLogicChannel(QPair<ValueType, QByteArray> data, QPair<ValueType, QByteArray> timeRaw, int bits, int zeroIndex);
 
   void reset();
@@ -78,11 +93,16 @@ public slots:
 
   void setMathFirst(int math, int ch);
   void setMathSecond(int math, int ch);
+  void setMathExpressionInputs(int math, QList<int> channels) { mathExpressionInputs[math - 1] = channels; }
 
   void setAverager(bool enabled) { averagerEnabled = enabled; }
 
+  void setLogicTransitionsOnly(bool enabled) { logicTransitionsOnly = enabled; }
+
 private slots:
   void updateCounterTimer();
+  /// Sends all collected points to the plot
+  void flushPointsToPlot();
 
 signals:
   /// Sends a message to the log
@@ -91,10 +111,13 @@ signals:
   /// Passes data to the plot
   void addVectorToPlot(int ch, QSharedPointer<QCPGraphDataContainer>, bool isMath = false);
 
-  /// Passes data to the plot
-  void addPointToPlot(int ch, double time, double value, bool append);
+  /// Passes collected points to the plot (append = false clears the channel first)
+  void addPointsToPlot(int ch, QSharedPointer<QCPGraphDataContainer> points, bool append);
+  /// Collected points that will not reach the plot, because a later point cleared the channel
+  void pointsNotPlotted(int ch, QSharedPointer<QCPGraphDataContainer> points);
   void clearLogic(int group, int fromBit);
   void addMathData(int mathNumber, bool isFirst, QSharedPointer<QCPGraphDataContainer> in, bool shouldIgnorePause = false);
+  void addMathExpressionData(int mathNumber, int input, QSharedPointer<QCPGraphDataContainer> in, bool shouldIgnorePause = false);
   void addDataToAverager(int chID, double samplingRate, QSharedPointer<QCPGraphDataContainer> data);
   void addPointToAverager(int ch, double time, double value, bool append);
   void setExpectedRange(int chID, bool known, double min, double max);
@@ -0,0 +1,188 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "rawrecorder.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+
+RawRecorder::RawRecorder(QObject *parent) : QObject(parent) {
+  statusTimer = new QTimer(this);
+  connect(statusTimer, &QTimer::timeout, this, &RawRecorder::reportStatus);
+}
+
+RawRecorder::~RawRecorder() { stop(); }
+
+void RawRecorder::append(const QByteArray &data) {
+  QMutexLocker locker(&mutex);
+  if (!recording)
+    return;
+  if (queuedBytes + data.size() > RECORDER_QUEUE_LIMIT) {
+    droppedBytes += data.size();
+    return;
+  }
+  queue.append(Pending{clock.nsecsElapsed(), data});
+  queuedBytes += data.size();
+  if (!writeRequested) {
+    writeRequested = true;
+    QMetaObject::invokeMethod(this, "writePending", Qt::QueuedConnection);
+  }
+}
+
+void RawRecorder::start(QString baseName, qint64 segmentSize, int segmentSeconds, qint64 diskBudget) {
+  stop();
+  this->baseName = baseName;
+  this->segmentSize = segmentSize;
+  this->segmentDuration = segmentSeconds * 1000000000LL;
+  this->diskBudget = diskBudget;
+  segmentNumber = 0;
+  segments.clear();
+  segmentsSize = 0;
+  writtenBytes = 0;
+  lastWrittenBytes = 0;
+
+  // Opening and preallocating the file may take a while, append() must not wait for it
+  if (!openSegment(0))
+    return;
+  {
+    QMutexLocker locker(&mutex);
+    droppedBytes = 0;
+    clock.start();
+    recording = true;
+  }
+
+  statusTimer->start(1000);
+  reportStatus();
+}
+
+void RawRecorder::stop() {
+  {
+    QMutexLocker locker(&mutex);
+    if (!recording)
+      return;
+    recording = false;
+  }
+  writePending();
+  closeSegment();
+  statusTimer->stop();
+  reportStatus();
+}
+
+bool RawRecorder::openSegment(qint64 timestamp) {
+  QString fileName = QString("%1_%2.dpcap").arg(baseName).arg(++segmentNumber, 4, 10, QChar('0'));
+  // The file is preallocated to the segment size (so it is not fragmented), unused space is cut off when the segment is closed
+  if (!writer.open(fileName, segmentSize)) {
+    emit sendMessage(tr("Recording failed"), writer.errorString().toUtf8(), MessageLevel::error);
+    return false;
+  }
+  segmentStart = timestamp;
+  return true;
+}
+
+bool RawRecorder::closeSegment() {
+  if (!writer.isOpen())
+    return true;
+  QString fileName = writer.fileName();
+  bool ok = writer.close();
+  if (!ok)
+    writeFailed();
+  addSegment(fileName);
+  return ok;
+}
+
+void RawRecorder::addSegment(const QString &fileName) {
+  qint64 size = QFileInfo(fileName).size();
+  segments.append(QPair<QString, qint64>(fileName, size));
+  segmentsSize += size;
+  enforceBudget();
+}
+
+void RawRecorder::enforceBudget() {
+  // The current segment (at most segmentSize) has to fit as well
+  while (!segments.isEmpty() && segmentsSize + segmentSize > diskBudget) {
+    QFile::remove(segments.first().first);
+    segmentsSize -= segments.first().second;
+    segments.removeFirst();
+  }
+}
+
+void RawRecorder::writePending() {
+  QVector<Pending> data;
+  {
+    QMutexLocker locker(&mutex);
+    data.swap(queue);
+    queuedBytes = 0;
+    writeRequested = false;
+  }
+
+  int i = 0;
+  for (; i < data.size(); i++) {
+    const Pending &pending = data.at(i);
+    if (!writer.isOpen())
+      break;
+    bool segmentFull = writer.size() + pending.data.size() > segmentSize || (segmentDuration > 0 && pending.timestamp - segmentStart > segmentDuration);
+    if (segmentFull && writer.size() > CaptureFile::FileHeaderSize) {
+      if (!closeSegment())
+        break;
+      if (!openSegment(pending.timestamp)) {
+        QMutexLocker locker(&mutex);
+        recording = false;
+        break;
+      }
+    }
+    writtenBytes += pending.data.size();
+    if (!writer.writeRaw(pending.timestamp, pending.data)) {
+      writeFailed();
+      addSegment(writer.fileName()); // The writer closed the cut off segment, it still takes disk space
+      i++; // Already counted by the writer as lost
+      break;
+    }
+  }
+
+  // After a failure the rest is dropped
+  qint64 rest = 0;
+  for (; i < data.size(); i++)
+    rest += data.at(i).data.size();
+  if (rest > 0) {
+    QMutexLocker locker(&mutex);
+    droppedBytes += rest;
+  }
+}
+
+void RawRecorder::writeFailed() {
+  // Bytes accepted by the writer were counted as written, the ones lost by the failed write are dropped instead
+  qint64 lost = writer.lostBytes();
+  writtenBytes -= lost;
+  {
+    QMutexLocker locker(&mutex);
+    droppedBytes += lost;
+    recording = false;
+  }
+  emit sendMessage(tr("Recording failed"), writer.errorString().toUtf8(), MessageLevel::error);
+}
+
+void RawRecorder::reportStatus() {
+  qint64 dropped;
+  bool isRecording;
+  {
+    QMutexLocker locker(&mutex);
+    dropped = droppedBytes;
+    isRecording = recording;
+  }
+  if (!isRecording)
+    statusTimer->stop();
+  qint64 rate = writtenBytes - lastWrittenBytes;
+  lastWrittenBytes = writtenBytes;
+  emit status(isRecording, writtenBytes, dropped, rate, writer.isOpen() ? QFileInfo(writer.fileName()).fileName() : QString());
+}
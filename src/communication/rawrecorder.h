@@ -0,0 +1,91 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef RAWRECORDER_H
+#define RAWRECORDER_H
+
+#include "communication/capturefile.h"
+#include "global.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+
+/// Records all received bytes into segmented capture files.
+/// Lives in its own thread, received data are only queued by append(), so a slow disk never blocks reading the port.
+/// When the queue is full, data are dropped and counted instead.
+class RawRecorder : public QObject {
+  Q_OBJECT
+public:
+  explicit RawRecorder(QObject *parent = nullptr);
+  ~RawRecorder();
+
+  /// Queues received data for writing, may be called from any thread
+  void append(const QByteArray &data);
+
+private:
+  struct Pending {
+    qint64 timestamp;
+    QByteArray data;
+  };
+
+  QMutex mutex;
+  QVector<Pending> queue;
+  qint64 queuedBytes = 0;
+  qint64 droppedBytes = 0;
+  bool recording = false;
+  bool writeRequested = false;
+  QElapsedTimer clock;
+
+  CaptureWriter writer;
+  QString baseName;
+  int segmentNumber = 0;
+  qint64 segmentSize = 0;
+  qint64 segmentDuration = 0;
+  qint64 segmentStart = 0;
+  qint64 diskBudget = 0;
+  /// Finished segments (oldest first) with their sizes
+  QList<QPair<QString, qint64>> segments;
+  qint64 segmentsSize = 0;
+  qint64 writtenBytes = 0;
+  qint64 lastWrittenBytes = 0;
+  QTimer *statusTimer;
+
+  bool openSegment(qint64 timestamp);
+  /// Returns false if the rest of the segment could not be written (recording is stopped)
+  bool closeSegment();
+  /// Counts a closed segment into the disk budget
+  void addSegment(const QString &fileName);
+  void enforceBudget();
+  /// Counts data lost by a failed write as dropped and stops recording
+  void writeFailed();
+
+private slots:
+  void writePending();
+  void reportStatus();
+
+public slots:
+  /// Starts recording into files baseName_0001.dpcap, baseName_0002.dpcap...
+  /// New segment is started after segmentSize bytes or segmentSeconds seconds, the oldest segments are deleted to fit into diskBudget bytes
+  void start(QString baseName, qint64 segmentSize, int segmentSeconds, qint64 diskBudget);
+  void stop();
+
+signals:
+  /// Bytes written and dropped since the start, write rate [B/s] and the current file
+  void status(bool recording, qint64 written, qint64 dropped, qint64 rate, QString fileName);
+  void sendMessage(QString header, QByteArray message, MessageLevel::enumMessageLevel type, MessageTarget::enumMessageTarget target = MessageTarget::manual);
+};
+
+#endif // RAWRECORDER_H
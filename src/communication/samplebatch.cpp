@@ -0,0 +1,196 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "samplebatch.h"
+#include <QtEndian>
+#include <cstring>
+
+/// Number of batches kept in the pool, more finished batches are deleted
+#define SAMPLE_BATCH_POOL_SIZE 64
+
+void SampleBatch::clear() {
+  values.clear(); // Capacity is preserved
+  columns.clear();
+  timeSource = timeValue;
+  timeStep = Column();
+  minimum = Column();
+  maximum = Column();
+  zeroIndex = 0;
+  bits = 0;
+}
+
+double SampleBatch::decodeBinary(const ValueType &type, const char *data, bool &isok) {
+  // Compose the bytes as little endian number
+  uint64_t raw = 0;
+  for (int i = 0; i < type.bytes; i++)
+    raw |= (uint64_t)(uint8_t)data[type.bigEndian ? (type.bytes - 1 - i) : i] << (8 * i);
+
+  isok = true;
+  if (type.type == ValueType::Type::unsignedint) {
+    if (type.bytes >= 1 && type.bytes <= 4)
+      return (double)raw;
+  } else if (type.type == ValueType::Type::integer) {
+    if (type.bytes == 1)
+      return (double)(int8_t)raw;
+    if (type.bytes == 2)
+      return (double)(int16_t)raw;
+    if (type.bytes == 4)
+      return (double)(int32_t)raw;
+  } else if (type.type == ValueType::Type::floatingpoint) {
+    if (type.bytes == 4) {
+      uint32_t raw32 = raw;
+      float value;
+      memcpy(&value, &raw32, 4);
+      return value;
+    }
+    if (type.bytes == 8) {
+      double value;
+      memcpy(&value, &raw, 8);
+      return value;
+    }
+  }
+  isok = false;
+  return 0;
+}
+
+/// Decoder specialized for one data type, width and byte order (picked once per channel, not per sample)
+template <typename Raw, typename Value, bool bigEndian> static void decodeBinarySamples(const char *data, int samples, int stride, double *out) {
+  static_assert(sizeof(Raw) == sizeof(Value), "Raw and Value must have the same size");
+  for (int i = 0; i < samples; i++) {
+    // Unaligned read with byte swap, then reinterpret the bits as the value type
+    Raw raw = bigEndian ? qFromBigEndian<Raw>(data + i * stride) : qFromLittleEndian<Raw>(data + i * stride);
+    Value value;
+    memcpy(&value, &raw, sizeof(Value));
+    out[i] = (double)value;
+  }
+}
+
+template <typename Raw, typename Value> static bool decodeBinarySamples(bool bigEndian, const char *data, int samples, int stride, double *out) {
+  if (bigEndian)
+    decodeBinarySamples<Raw, Value, true>(data, samples, stride, out);
+  else
+    decodeBinarySamples<Raw, Value, false>(data, samples, stride, out);
+  return true;
+}
+
+bool SampleBatch::decodeBinaryArray(const ValueType &type, const char *data, int samples, int stride, double *out) {
+  if (type.type == ValueType::Type::unsignedint) {
+    if (type.bytes == 1)
+      return decodeBinarySamples<uint8_t, uint8_t>(type.bigEndian, data, samples, stride, out);
+    if (type.bytes == 2)
+      return decodeBinarySamples<uint16_t, uint16_t>(type.bigEndian, data, samples, stride, out);
+    if (type.bytes == 4)
+      return decodeBinarySamples<uint32_t, uint32_t>(type.bigEndian, data, samples, stride, out);
+  } else if (type.type == ValueType::Type::integer) {
+    if (type.bytes == 1)
+      return decodeBinarySamples<uint8_t, int8_t>(type.bigEndian, data, samples, stride, out);
+    if (type.bytes == 2)
+      return decodeBinarySamples<uint16_t, int16_t>(type.bigEndian, data, samples, stride, out);
+    if (type.bytes == 4)
+      return decodeBinarySamples<uint32_t, int32_t>(type.bigEndian, data, samples, stride, out);
+  } else if (type.type == ValueType::Type::floatingpoint) {
+    if (type.bytes == 4)
+      return decodeBinarySamples<uint32_t, float>(type.bigEndian, data, samples, stride, out);
+    if (type.bytes == 8)
+      return decodeBinarySamples<uint64_t, double>(type.bigEndian, data, samples, stride, out);
+  }
+
+  // Other widths (e.g. 3 byte unsigned) sample by sample
+  bool isok = true;
+  for (int i = 0; i < samples; i++)
+    out[i] = decodeBinary(type, data + i * stride, isok);
+  return isok;
+}
+
+SampleBatch::Column SampleBatch::decodeField(const ValueType &type, const char *data, int length) {
+  Column column;
+  column.type = type;
+  column.offset = values.size();
+  if (length == 0)
+    return column;
+
+  bool isok;
+  double value;
+  if (type.isBinary)
+    value = decodeBinary(type, data, isok);
+  else
+    value = QByteArray::fromRawData(data, length).toDouble(&isok);
+
+  if (!isok) {
+    column.isValid = false;
+    column.invalidText = QByteArray(data, length);
+    return column;
+  }
+  values.append(value);
+  column.count = 1;
+  return column;
+}
+
+void SampleBatch::appendField(const ValueType &type, const char *data, int length) {
+  if (columns.isEmpty() && !type.isBinary) {
+    // Time of point can be replaced by a keyword or left empty
+    if (length == 0)
+      timeSource = timeImplicit;
+    else if (length == 4 && memcmp(data, "-tod", 4) == 0)
+      timeSource = timeOfDay;
+    else if (length == 5 && memcmp(data, "-auto", 5) == 0)
+      timeSource = timeAutomatic;
+    if (timeSource != timeValue) {
+      Column column;
+      column.type = type;
+      column.offset = values.size();
+      columns.append(column);
+      return;
+    }
+  }
+  columns.append(decodeField(type, data, length));
+}
+
+void SampleBatch::appendChannel(const ValueType &type, const char *data, int length, int channel, int interleave, int position) {
+  Column column;
+  column.type = type;
+  column.channel = channel;
+  column.offset = values.size();
+
+  const int stride = type.bytes * interleave;
+  const int samples = MAX((length - position * type.bytes + stride - 1) / stride, 0);
+  values.resize(column.offset + samples);
+  column.isValid = decodeBinaryArray(type, data + position * type.bytes, samples, stride, values.data() + column.offset);
+  column.count = samples;
+  columns.append(column);
+}
+
+void SampleBatchPool::Storage::release(SampleBatch *batch) {
+  QMutexLocker locker(&mutex);
+  if (freeBatches.size() >= SAMPLE_BATCH_POOL_SIZE) {
+    delete batch;
+    return;
+  }
+  batch->clear();
+  freeBatches.append(batch);
+}
+
+QSharedPointer<SampleBatch> SampleBatchPool::acquire() {
+  SampleBatch *batch = nullptr;
+  {
+    QMutexLocker locker(&storage->mutex);
+    if (!storage->freeBatches.isEmpty())
+      batch = storage->freeBatches.takeLast();
+  }
+  if (batch == nullptr)
+    batch = new SampleBatch;
+  QSharedPointer<Storage> owner = storage;
+  return QSharedPointer<SampleBatch>(batch, [owner](SampleBatch *batch) { owner->release(batch); });
+}
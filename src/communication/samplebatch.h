@@ -0,0 +1,105 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SAMPLEBATCH_H
+#define SAMPLEBATCH_H
+
+#include "global.h"
+#include <QByteArray>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+/// Decoded values of one received point or channel frame.
+/// All samples are stored in a single vector, columns only point into it.
+struct SampleBatch {
+  /// Where the time of a point comes from
+  enum TimeSource { timeValue, timeImplicit, timeOfDay, timeAutomatic };
+
+  struct Column {
+    /// Received data type, the multiplier is not yet applied to the values
+    ValueType type;
+    /// Index of the first sample in values
+    int offset = 0;
+    /// Number of samples (0 if the value was left empty)
+    int count = 0;
+    /// Channel number (channel frames only)
+    int channel = 0;
+    /// False if the received text is not a number
+    bool isValid = true;
+    /// Received text which is not a number (for the error message)
+    QByteArray invalidText;
+  };
+
+  QVector<double> values;
+  /// Point: time followed by channel 1, 2, ...; Channel frame: one column per channel
+  QVector<Column> columns;
+
+  // Point only
+  TimeSource timeSource = timeValue;
+
+  // Channel frame only
+  Column timeStep, minimum, maximum;
+  int zeroIndex = 0;
+  int bits = 0;
+
+  /// Empties the batch, allocated memory is kept for reuse
+  void clear();
+  /// Decodes single value (binary or text) into values, empty data means no value
+  Column decodeField(const ValueType &type, const char *data, int length);
+  Column decodeField(const QPair<ValueType, QByteArray> &field) { return decodeField(field.first, field.second.constData(), field.second.length()); }
+  /// Appends a point column (the first one is the time)
+  void appendField(const ValueType &type, const char *data, int length);
+  /// Appends a channel column decoded from binary data.
+  /// With interleave > 1, only every interleave-th sample starting at position is taken.
+  void appendChannel(const ValueType &type, const char *data, int length, int channel, int interleave = 1, int position = 0);
+
+  /// Value with the multiplier applied
+  double value(const Column &column, int index = 0) const { return values.at(column.offset + index) * column.type.multiplier; }
+  /// Raw value as bits (for logic channels)
+  uint32_t bitsOf(const Column &column, int index = 0) const { return (uint32_t)values.at(column.offset + index); }
+  bool hasValue(const Column &column) const { return column.count > 0; }
+
+  /// Decodes a binary value, without applying the multiplier
+  static double decodeBinary(const ValueType &type, const char *data, bool &isok);
+  /// Decodes (samples) binary values placed (stride) bytes apart, without applying the multiplier.
+  /// The decoder for the data type is selected once, returns false for unsupported type.
+  static bool decodeBinaryArray(const ValueType &type, const char *data, int samples, int stride, double *out);
+};
+
+/// Keeps finished batches for reuse, so that their memory does not need to be allocated again for every point
+class SampleBatchPool {
+  /// Free batches. Every acquired batch holds a reference to it, so a batch released after the pool
+  /// is destroyed (e.g. still queued in a worker thread at exit) does not touch a destroyed object.
+  struct Storage {
+    QMutex mutex;
+    QVector<SampleBatch *> freeBatches;
+    ~Storage() { qDeleteAll(freeBatches); }
+    void release(SampleBatch *batch);
+  };
+  QSharedPointer<Storage> storage;
+  SampleBatchPool() : storage(new Storage) {}
+
+public:
+  static SampleBatchPool &getInstance() {
+    static SampleBatchPool instance; // Constructed on first use
+    return instance;
+  }
+
+  /// Returns an empty batch, it goes back to the pool once the last pointer to it is released
+  QSharedPointer<SampleBatch> acquire();
+};
+
+#endif // SAMPLEBATCH_H
@@ -0,0 +1,269 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "samplelogger.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+
+SampleLogger::SampleLogger(QObject *parent) : QObject(parent) {
+  statusTimer = new QTimer(this);
+  connect(statusTimer, &QTimer::timeout, this, &SampleLogger::reportStatus);
+}
+
+SampleLogger::~SampleLogger() { stop(); }
+
+void SampleLogger::queueRequestWrite() {
+  // Called with the mutex locked
+  if (!writeRequested) {
+    writeRequested = true;
+    QMetaObject::invokeMethod(this, "writePending", Qt::QueuedConnection);
+  }
+}
+
+bool SampleLogger::isLogged(int chID) { return chID >= 0 && (chID < ANALOG_COUNT || (IS_LOGIC_CH(chID) && chID < ALL_COUNT)); }
+
+void SampleLogger::append(int chID, QSharedPointer<QCPGraphDataContainer> data) {
+  if (!isLogged(chID) || data.isNull() || data->isEmpty())
+    return;
+  QMutexLocker locker(&mutex);
+  if (!logging)
+    return;
+  if (queuedSamples + data->size() > LOGGER_QUEUE_LIMIT) {
+    droppedSamples += data->size();
+    return;
+  }
+  // Samples are copied, the plot keeps appending to the container it got and must never share its buffer
+  queue.append(Pending{clock.nsecsElapsed(), chID, QVector<QCPGraphData>(data->size()), false});
+  std::copy(data->constBegin(), data->constEnd(), queue.last().samples.begin());
+  queuedSamples += data->size();
+  queueRequestWrite();
+}
+
+void SampleLogger::appendPoint(int chID, double time, double value) {
+  if (!isLogged(chID))
+    return;
+  QMutexLocker locker(&mutex);
+  if (!logging)
+    return;
+  if (queuedSamples >= LOGGER_QUEUE_LIMIT) {
+    droppedSamples++;
+    return;
+  }
+  if (queue.isEmpty() || !queue.last().ownPoints || queue.last().chID != chID)
+    queue.append(Pending{clock.nsecsElapsed(), chID, QVector<QCPGraphData>(), true});
+  queue.last().samples.append(QCPGraphData(time, value));
+  queuedSamples++;
+  queueRequestWrite();
+}
+
+void SampleLogger::start(QString baseName, bool binary, TableExporter::Format format, qint64 segmentSize, int segmentSeconds) {
+  stop();
+  this->baseName = baseName;
+  this->binary = binary;
+  this->format = format;
+  this->segmentSize = segmentSize;
+  this->segmentDuration = segmentSeconds * 1000000000LL;
+  segmentNumber = 0;
+  writtenSamples = 0;
+  lastWrittenSamples = 0;
+
+  // Opening and preallocating the file may take a while, append() must not wait for it
+  if (!openSegment(0))
+    return;
+  {
+    QMutexLocker locker(&mutex);
+    droppedSamples = 0;
+    clock.start();
+    logging = true;
+  }
+
+  statusTimer->start(1000);
+  reportStatus();
+}
+
+void SampleLogger::stop() {
+  {
+    QMutexLocker locker(&mutex);
+    if (!logging)
+      return;
+    logging = false;
+  }
+  writePending();
+  closeSegment();
+  statusTimer->stop();
+  reportStatus();
+}
+
+bool SampleLogger::openSegment(qint64 timestamp) {
+  QString fileName = QString("%1_%2.%3").arg(baseName).arg(++segmentNumber, 4, 10, QChar('0')).arg(binary ? "dpcap" : "csv");
+  segmentStart = timestamp;
+  if (binary) {
+    if (!captureWriter.open(fileName, segmentSize)) {
+      emit sendMessage(tr("Logging failed"), captureWriter.errorString().toUtf8(), MessageLevel::error);
+      return false;
+    }
+    return true;
+  }
+  csvFile.setFileName(fileName);
+  if (!csvFile.open(QFile::WriteOnly | QFile::Truncate)) {
+    emit sendMessage(tr("Logging failed"), csvFile.errorString().toUtf8(), MessageLevel::error);
+    return false;
+  }
+  csvBuffer.clear();
+  csvBuffer.reserve(LOGGER_BLOCK_SIZE + 1024);
+  csvBuffer.append(tr("channel").toUtf8());
+  csvBuffer.append(format.separator);
+  csvBuffer.append(tr("time").toUtf8());
+  csvBuffer.append(format.separator);
+  csvBuffer.append(tr("value").toUtf8());
+  csvBuffer.append('\n');
+  csvSize = csvBuffer.size();
+  csvBufferedSamples = 0;
+  return true;
+}
+
+bool SampleLogger::closeSegment() {
+  if (binary) {
+    if (captureWriter.close())
+      return true;
+    writeFailed(captureWriter.lostBytes() / (qint64)(2 * sizeof(double)), captureWriter.errorString());
+    return false;
+  }
+  if (!csvFile.isOpen())
+    return true;
+  bool ok = flushCsv();
+  csvFile.close();
+  return ok;
+}
+
+bool SampleLogger::flushCsv() {
+  if (csvBuffer.isEmpty() || !csvFile.isOpen())
+    return true;
+  if (csvFile.write(csvBuffer) != csvBuffer.size()) {
+    QString error = csvFile.errorString();
+    csvFile.close();
+    csvBuffer.clear();
+    writeFailed(csvBufferedSamples, error);
+    return false;
+  }
+  csvBuffer.clear();
+  csvBufferedSamples = 0;
+  return true;
+}
+
+void SampleLogger::writeFailed(qint64 lost, const QString &error) {
+  // Samples accepted for writing were counted as written, the ones lost by the failed write are dropped instead
+  writtenSamples -= lost;
+  {
+    QMutexLocker locker(&mutex);
+    droppedSamples += lost;
+    logging = false;
+  }
+  emit sendMessage(tr("Logging failed"), error.toUtf8(), MessageLevel::error);
+}
+
+bool SampleLogger::writeBatch(const Pending &pending) {
+  int count = pending.samples.size();
+  writtenSamples += count;
+  // Logic bits are drawn shifted by 3 per bit, the log holds 0 or 1
+  bool isLogic = IS_LOGIC_CH(pending.chID);
+  double offset = isLogic ? ChID_TO_LOGIC_GROUP_BIT(pending.chID) * 3 : 0;
+  if (binary) {
+    // Capture files store times and values as separate columns, channel numbers are from 1 (chID + 1 for logic bits too)
+    QVector<double> times(count), values(count);
+    auto it = pending.samples.constBegin();
+    for (int i = 0; i < count; i++, it++) {
+      times[i] = it->key;
+      values[i] = it->value - offset;
+    }
+    if (!captureWriter.writeDecoded(pending.timestamp, pending.chID + 1, times.constData(), values.constData(), count)) {
+      writeFailed(captureWriter.lostBytes() / (qint64)(2 * sizeof(double)), captureWriter.errorString());
+      return false;
+    }
+    return true;
+  }
+  QByteArray channel = isLogic ? QString("L%1.%2").arg(ChID_TO_LOGIC_GROUP(pending.chID) + 1).arg(ChID_TO_LOGIC_GROUP_BIT(pending.chID)).toLatin1() : QByteArray::number(pending.chID + 1);
+  for (auto it = pending.samples.constBegin(); it != pending.samples.constEnd(); it++) {
+    csvBuffer.append(channel);
+    csvBuffer.append(format.separator);
+    TableExporter::appendNumber(csvBuffer, it->key, format.precision, format.decimal);
+    csvBuffer.append(format.separator);
+    TableExporter::appendNumber(csvBuffer, it->value - offset, format.precision, format.decimal);
+    csvBuffer.append('\n');
+  }
+  csvBufferedSamples += count;
+  csvSize = csvFile.pos() + csvBuffer.size();
+  if (csvBuffer.size() >= LOGGER_BLOCK_SIZE)
+    return flushCsv();
+  return true;
+}
+
+void SampleLogger::writePending() {
+  QVector<Pending> data;
+  {
+    QMutexLocker locker(&mutex);
+    data.swap(queue);
+    queuedSamples = 0;
+    writeRequested = false;
+  }
+
+  int i = 0;
+  for (; i < data.size(); i++) {
+    const Pending &pending = data.at(i);
+    if (!isSegmentOpen())
+      break;
+    bool segmentFull = currentSegmentSize() >= segmentSize || (segmentDuration > 0 && pending.timestamp - segmentStart > segmentDuration);
+    if (segmentFull) {
+      if (!closeSegment())
+        break;
+      if (!openSegment(pending.timestamp)) {
+        QMutexLocker locker(&mutex);
+        logging = false;
+        break;
+      }
+    }
+    if (!writeBatch(pending)) {
+      i++; // Already counted as lost
+      break;
+    }
+  }
+
+  // After a failure the rest is dropped
+  qint64 rest = 0;
+  for (; i < data.size(); i++)
+    rest += data.at(i).samples.size();
+  if (rest > 0) {
+    QMutexLocker locker(&mutex);
+    droppedSamples += rest;
+  }
+}
+
+void SampleLogger::reportStatus() {
+  // Data written at least once a second, so not much is lost when the application is killed
+  flushCsv();
+  qint64 dropped, backlog;
+  bool isLogging;
+  {
+    QMutexLocker locker(&mutex);
+    dropped = droppedSamples;
+    backlog = queuedSamples;
+    isLogging = logging;
+  }
+  if (!isLogging)
+    statusTimer->stop();
+  qint64 rate = writtenSamples - lastWrittenSamples;
+  lastWrittenSamples = writtenSamples;
+  emit status(isLogging, writtenSamples, backlog, dropped, rate, isSegmentOpen() ? QFileInfo(currentFileName()).fileName() : QString());
+}
@@ -0,0 +1,109 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SAMPLELOGGER_H
+#define SAMPLELOGGER_H
+
+#include "communication/capturefile.h"
+#include "communication/tableexporter.h"
+#include "global.h"
+#include "plots/qcustomplot.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+
+/// Logs every decoded sample of the analog and logic channels into segmented files, either CSV (channel, time, value)
+/// or capture files with decoded chunks (analog channels can be replayed later).
+/// Logic bits are logged as 0 or 1, in CSV their channel is L<group>.<bit>, in capture files chID + 1.
+/// Gets the same batches as the plot (independently of the plot being paused) by append(), which only queues them,
+/// the logger lives in its own thread and writes them in large blocks. When the queue is full, samples are dropped and counted.
+class SampleLogger : public QObject {
+  Q_OBJECT
+public:
+  explicit SampleLogger(QObject *parent = nullptr);
+  ~SampleLogger();
+
+  /// Queues copy of samples of a channel (chID is index of the channel), may be called from any thread
+  void append(int chID, QSharedPointer<QCPGraphDataContainer> data);
+  /// Queues one sample of a channel, may be called from any thread
+  void appendPoint(int chID, double time, double value);
+
+private:
+  struct Pending {
+    qint64 timestamp;
+    int chID;
+    QVector<QCPGraphData> samples;
+    /// Created for single points, so more points may be added to it
+    bool ownPoints;
+  };
+
+  QMutex mutex;
+  QVector<Pending> queue;
+  qint64 queuedSamples = 0;
+  qint64 droppedSamples = 0;
+  bool logging = false;
+  bool writeRequested = false;
+  QElapsedTimer clock;
+  void queueRequestWrite();
+  /// Analog channels and logic bits are logged, math channels are not (they are not received)
+  static bool isLogged(int chID);
+
+  bool binary = false;
+  TableExporter::Format format;
+  CaptureWriter captureWriter;
+  QFile csvFile;
+  QByteArray csvBuffer;
+  /// Samples in csvBuffer
+  qint64 csvBufferedSamples = 0;
+  qint64 csvSize = 0;
+  QString baseName;
+  int segmentNumber = 0;
+  qint64 segmentSize = 0;
+  qint64 segmentDuration = 0;
+  qint64 segmentStart = 0;
+  qint64 writtenSamples = 0;
+  qint64 lastWrittenSamples = 0;
+  QTimer *statusTimer;
+
+  bool openSegment(qint64 timestamp);
+  /// Returns false if the rest of the segment could not be written (logging is stopped)
+  bool closeSegment();
+  bool isSegmentOpen() const { return binary ? captureWriter.isOpen() : csvFile.isOpen(); }
+  qint64 currentSegmentSize() const { return binary ? captureWriter.size() : csvSize; }
+  QString currentFileName() const { return binary ? captureWriter.fileName() : csvFile.fileName(); }
+  /// Returns false if writing failed (logging is stopped)
+  bool writeBatch(const Pending &pending);
+  bool flushCsv();
+  /// Counts samples lost by a failed write as dropped and stops logging
+  void writeFailed(qint64 lost, const QString &error);
+
+private slots:
+  void writePending();
+  void reportStatus();
+
+public slots:
+  /// Starts logging into files baseName_0001.csv (or .dpcap if binary), baseName_0002.csv...
+  /// New segment is started after segmentSize bytes or segmentSeconds seconds, CSV is written using format
+  void start(QString baseName, bool binary, TableExporter::Format format, qint64 segmentSize, int segmentSeconds);
+  void stop();
+
+signals:
+  /// Samples written, waiting in the queue and dropped since the start, write rate [samples/s] and the current file
+  void status(bool logging, qint64 written, qint64 backlog, qint64 dropped, qint64 rate, QString fileName);
+  void sendMessage(QString header, QByteArray message, MessageLevel::enumMessageLevel type, MessageTarget::enumMessageTarget target = MessageTarget::manual);
+};
+
+#endif // SAMPLELOGGER_H
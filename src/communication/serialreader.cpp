@@ -14,6 +14,7 @@
 //  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "serialreader.h"
+#include <limits>
 
 SerialReader::SerialReader(QObject *parent) : QObject(parent) {}
 
@@ -34,6 +35,8 @@ void SerialReader::startSimulatedInput() {
 }
 
 void SerialReader::newData(QByteArray data) {
+  if (recorder != nullptr && !replayConnected)
+    recorder->append(data);
   emit sendData(data);
   if (serialMonitor)
     emit monitor(data);
@@ -51,6 +54,8 @@ void SerialReader::init() {
   // the GUI thread.
   serial = new QSerialPort(this);
   telnet = new TelnetServer(this);
+  replayTimer = new QTimer(this);
+  connect(replayTimer, &QTimer::timeout, this, &SerialReader::replayNext);
   connect(serial, &QSerialPort::bytesWritten, this, &SerialReader::finishedWriting);
   // Older Qt versions (e.g. Windows XP) do not have the error signal
 #if QT_VERSION >= 0x050800
@@ -59,7 +64,7 @@ void SerialReader::init() {
 }
 
 void SerialReader::begin(QString portName, int baudRate, QSerialPort::DataBits dataBits, QSerialPort::Parity parity, QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControll) {
-  if (serial->isOpen() || simConnected || telnetConnected)
+  if (serial->isOpen() || simConnected || telnetConnected || replayConnected)
     end(); // Close the port if it is already open
 
   if (portName == "~SPECIAL~SIM") {
@@ -81,6 +86,22 @@ void SerialReader::begin(QString portName, int baudRate, QSerialPort::DataBits d
     return;
   }
 
+  if (portName == "~SPECIAL~REPLAY") {
+    if (replayFileName.isEmpty()) {
+      emit connectionResult(false, tr("No file"), tr("Select a capture file to replay"));
+      return;
+    }
+    if (!replay.open(replayFileName)) {
+      emit connectionResult(false, tr("Error"), replay.errorString());
+      return;
+    }
+    replayConnected = true;
+    replayPosition = 0;
+    emit connectionResult(true, tr("Replay"), QFileInfo(replayFileName).fileName());
+    emit started(); // Replay starts after the parser is ready
+    return;
+  }
+
   serial->setPortName(portName);
   serial->setBaudRate(baudRate);
   serial->setDataBits(dataBits);
@@ -117,7 +138,41 @@ void SerialReader::write(QByteArray data) {
     telnet->write(data);
 }
 
-void SerialReader::parserReady() { connect(serial, &QSerialPort::readyRead, this, &SerialReader::read); }
+void SerialReader::parserReady() {
+  if (replayConnected) {
+    replayStartTime = (replayPosition < replay.chunkCount()) ? replay.timestamp(replayPosition) : 0;
+    replayClock.start();
+    replayTimer->start(CAPTURE_REPLAY_INTERVAL);
+    return;
+  }
+  connect(serial, &QSerialPort::readyRead, this, &SerialReader::read);
+}
+
+void SerialReader::replayNext() {
+  // Chunks are sent when their time comes (relative to the first one), but at most CAPTURE_REPLAY_MAX_BYTES at once
+  qint64 until = (replaySpeed > 0) ? replayStartTime + (qint64)(replayClock.nsecsElapsed() * replaySpeed) : std::numeric_limits<qint64>::max();
+  qint64 bytes = 0;
+  while (replayPosition < replay.chunkCount() && bytes < CAPTURE_REPLAY_MAX_BYTES) {
+    if (replay.timestamp(replayPosition) > until)
+      break;
+    CaptureReader::Chunk chunk = replay.chunk(replayPosition++);
+    if (chunk.type == CaptureFile::raw)
+      newData(QByteArray(chunk.data, chunk.length));
+    else if (chunk.type == CaptureFile::decoded)
+      newData(CaptureReader::decodedToPoints(chunk));
+    bytes += chunk.length;
+  }
+  if (replayPosition >= replay.chunkCount()) {
+    replayTimer->stop();
+    emit connectionResult(true, tr("Replay finished"), QFileInfo(replayFileName).fileName());
+  }
+}
+
+void SerialReader::endReplay() {
+  replayTimer->stop();
+  replay.close();
+  replayConnected = false;
+}
 
 void SerialReader::changeBaud(qint32 baud) {
   if (!serial->isOpen())
@@ -151,6 +206,8 @@ void SerialReader::end() {
   if (telnetConnected)
     telnet->disconnect();
   telnetConnected = false;
+  if (replayConnected)
+    endReplay();
   disconnect(serial, &QSerialPort::readyRead, this, &SerialReader::read);
   disconnect(telnet, &TelnetServer::messageReceived, this, &SerialReader::newData);
   emit connectionResult(false, tr("Not connected"), "");
@@ -182,7 +239,7 @@ void SerialReader::errorOccurred() {
 }
 
 void SerialReader::toggle(QString portName, int baudRate, QSerialPort::DataBits dataBits, QSerialPort::Parity parity, QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControll) {
-  if (!serial->isOpen() && !simConnected && !telnetConnected)
+  if (!serial->isOpen() && !simConnected && !telnetConnected && !replayConnected)
     begin(portName, baudRate, dataBits, parity, stopBits, flowControll);
   else
     end();
@@ -16,9 +16,12 @@
 #ifndef SERIALREADER_H
 #define SERIALREADER_H
 
+#include "communication/capturefile.h"
+#include "communication/rawrecorder.h"
 #include "communication/telnetserver.h"
 #include "manualinputdialog.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QSerialPort>
 #include <QThread>
@@ -29,6 +32,8 @@ public:
   explicit SerialReader(QObject *parent = nullptr);
   ~SerialReader();
   void setSimInputDialog(QSharedPointer<ManualInputDialog> simIn);
+  /// Received data are also passed to the recorder (it queues them, so reading is never delayed)
+  void setRecorder(RawRecorder *recorder) { this->recorder = recorder; }
 
 private:
   QSerialPort *serial;
@@ -40,10 +45,22 @@ private:
   bool simConnected = false;
   bool telnetConnected = false;
   TelnetServer *telnet;
+  RawRecorder *recorder = nullptr;
+  CaptureReader replay;
+  QString replayFileName;
+  /// Replay speed relative to real time (0 = as fast as possible)
+  double replaySpeed = 1;
+  bool replayConnected = false;
+  int replayPosition = 0;
+  qint64 replayStartTime = 0;
+  QElapsedTimer replayClock;
+  QTimer *replayTimer;
+  void endReplay();
 
 private slots:
   void read();
   void errorOccurred();
+  void replayNext();
 signals:
   /// Sends information whether the port is connected
   void connectionResult(bool connected, QString caption, QString details);
@@ -74,6 +91,11 @@ public slots:
   void enableMonitoring(bool en) { serialMonitor = en; }
   /// If the port is connected, change baud without disconnecting
   void changeBaud(qint32 baud);
+  /// Sets the capture file and speed used by the replay source
+  void setReplay(QString fileName, double speed) {
+    replayFileName = fileName;
+    replaySpeed = speed;
+  }
 };
 
 #endif // SERIALREADER_H
@@ -0,0 +1,179 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "tableexporter.h"
+#include "columnfile.h"
+#include <QFile>
+#include <cmath>
+
+TableExporter::TableExporter(QObject *parent) : QObject(parent) {}
+
+void TableExporter::appendNumber(QByteArray &output, double value, int precision, char decimal) {
+  static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+  // Value scaled to an integer has to be exactly representable, otherwise the slow path is used
+  if (precision < 0 || precision > 15 || !std::isfinite(value) || std::fabs(value) * powers[precision] >= 9e15) {
+    output.append(QByteArray::number(value, 'f', precision).replace('.', decimal));
+    return;
+  }
+
+  // Product is rounded before llround, exact remainder (by fma) corrects the result when it was rounded across .5
+  qint64 scaled = std::llround(value * powers[precision]);
+  double rest = std::fma(value, powers[precision], -(double)scaled);
+  if (rest > 0.5)
+    scaled++;
+  else if (rest < -0.5)
+    scaled--;
+  else if (std::fabs(rest) == 0.5) {
+    output.append(QByteArray::number(value, 'f', precision).replace('.', decimal));
+    return;
+  }
+  quint64 magnitude = scaled < 0 ? -scaled : scaled;
+
+  // Digits are generated from the end, at least one digit has to be before the decimal point
+  char digits[24];
+  int length = 0;
+  do {
+    digits[length++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude != 0);
+  while (length <= precision)
+    digits[length++] = '0';
+
+  char text[32];
+  int position = 0;
+  if (scaled < 0)
+    text[position++] = '-';
+  for (int i = length - 1; i >= 0; i--) {
+    text[position++] = digits[i];
+    if (i == precision && precision > 0)
+      text[position++] = decimal;
+  }
+  output.append(text, position);
+}
+
+bool TableExporter::writeCSV(QIODevice &device, const QVector<Column> &columns, const Format &format) {
+  QByteArray output;
+  output.reserve(CSV_EXPORT_CHUNK + 1024);
+
+  output.append(tr("time").toUtf8());
+  qint64 total = 0;
+  for (const Column &column : columns) {
+    output.append(format.separator);
+    output.append(column.name.toUtf8());
+    total += column.data.size();
+  }
+
+  // Rows are merged from channels sorted by time, each channel has a cursor to its first unwritten sample.
+  // Samples with the same time (from different channels) are written in the same row.
+  QVector<int> positions(columns.size(), 0);
+  qint64 written = 0;
+  int lastPercent = -1;
+  forever {
+    double time = INFINITY;
+    for (int i = 0; i < columns.size(); i++)
+      if (positions.at(i) < columns.at(i).data.size())
+        time = MIN(time, columns.at(i).data.at(positions.at(i)).key);
+    if (time == INFINITY)
+      break;
+
+    output.append('\n');
+    appendNumber(output, time, format.precision, format.decimal);
+    for (int i = 0; i < columns.size(); i++) {
+      output.append(format.separator);
+      const Column &column = columns.at(i);
+      int &position = positions[i];
+      if (position < column.data.size() && column.data.at(position).key == time) {
+        double value = column.data.at(position).value;
+        if (column.isLogic)
+          value = ((int)round(value)) % 3;
+        appendNumber(output, value, format.precision, format.decimal);
+        position++;
+        written++;
+      }
+    }
+
+    if (output.size() >= CSV_EXPORT_CHUNK) {
+      if (device.write(output) != output.size())
+        return false;
+      output.clear();
+      output.reserve(CSV_EXPORT_CHUNK + 1024);
+      if (canceled)
+        return false;
+      reportProgress(written, total, lastPercent);
+    }
+  }
+  return device.write(output) == output.size();
+}
+
+void TableExporter::reportProgress(qint64 written, qint64 total, int &lastPercent) {
+  int percent = written * 100 / total;
+  if (percent != lastPercent) {
+    lastPercent = percent;
+    emit progress(percent);
+  }
+}
+
+void TableExporter::exportCSV(QString fileName, QVector<TableExporter::Column> columns, TableExporter::Format format) {
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+    emit finished(false, fileName, file.errorString());
+    return;
+  }
+  bool success = writeCSV(file, columns, format);
+  QString error = file.errorString();
+  file.close();
+  if (!success) {
+    error = canceled ? tr("Export canceled") : error;
+    file.remove();
+  }
+  emit finished(success, fileName, error);
+}
+
+void TableExporter::exportColumnFile(QString fileName, QVector<TableExporter::Column> columns) {
+  ColumnFileWriter writer;
+  if (!writer.open(fileName)) {
+    emit finished(false, fileName, writer.errorString());
+    return;
+  }
+
+  qint64 total = 0;
+  for (const Column &column : qAsConst(columns))
+    total += column.data.size();
+
+  bool success = true;
+  qint64 written = 0;
+  int lastPercent = -1;
+  for (const Column &column : qAsConst(columns)) {
+    double t0 = 0, dt = 0;
+    if (!ColumnFileWriter::uniformTime(column.data, t0, dt))
+      t0 = dt = 0;
+    writer.beginChannel(column.name, ColumnFileWriter::valueType(column.data, column.isLogic), t0, dt);
+    for (int i = 0; i < column.data.size() && success; i += COLUMN_FILE_BLOCK_SAMPLES) {
+      success = writer.writeBlock(&column.data.at(i), MIN(COLUMN_FILE_BLOCK_SAMPLES, column.data.size() - i)) && !canceled;
+      written += MIN(COLUMN_FILE_BLOCK_SAMPLES, column.data.size() - i);
+      reportProgress(written, total, lastPercent);
+    }
+    if (!success)
+      break;
+  }
+
+  QString error = writer.errorString();
+  success = writer.close() && success;
+  if (!success) {
+    error = canceled ? tr("Export canceled") : error;
+    QFile::remove(fileName);
+  }
+  emit finished(success, fileName, error);
+}
@@ -0,0 +1,72 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TABLEEXPORTER_H
+#define TABLEEXPORTER_H
+
+#include "global.h"
+#include "math/channelsnapshot.h"
+#include <QIODevice>
+#include <QObject>
+#include <atomic>
+
+/// Exports channels of the main plot as a table, either CSV (time column + one column per channel)
+/// or binary column file (see ColumnFile).
+/// Channels are already sorted by time, so CSV rows are produced by merging them, the table is never held in memory as a whole.
+/// Lives in its own thread, export can be canceled from any thread.
+class TableExporter : public QObject {
+  Q_OBJECT
+public:
+  struct Column {
+    QString name;
+    ChannelSnapshot data;
+    /// Logic bit channel, values are written as 0/1
+    bool isLogic = false;
+  };
+
+  struct Format {
+    char separator = ',';
+    char decimal = '.';
+    int precision = 6;
+  };
+
+  explicit TableExporter(QObject *parent = nullptr);
+
+  /// Writes CSV table to an open device, returns false if writing failed or was canceled
+  bool writeCSV(QIODevice &device, const QVector<Column> &columns, const Format &format);
+
+  /// Appends value formatted the same way as QString::number(value, 'f', precision) with the given decimal separator
+  static void appendNumber(QByteArray &output, double value, int precision, char decimal);
+
+  /// Stops the running (or the next queued) export, may be called from any thread
+  void cancel() { canceled = true; }
+  /// Clears previous cancel, call from the requesting thread before queuing a new export (a cancel that comes before the export starts is kept)
+  void clearCancel() { canceled = false; }
+
+private:
+  std::atomic<bool> canceled{false};
+  void reportProgress(qint64 written, qint64 total, int &lastPercent);
+
+public slots:
+  void exportCSV(QString fileName, QVector<TableExporter::Column> columns, TableExporter::Format format);
+  void exportColumnFile(QString fileName, QVector<TableExporter::Column> columns);
+
+signals:
+  /// Percentage of samples already written
+  void progress(int percent);
+  void finished(bool success, QString fileName, QString error);
+};
+
+#endif // TABLEEXPORTER_H
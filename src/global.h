@@ -51,6 +51,63 @@ const char MisrosoftStoreUrl[] = "https://apps.microsoft.com/detail/9NVBN2G853FP
 
 #define MAX_PLOT_ZOOMOUT 10000000000
 
+/// Received points are collected and sent to the plot at most every POINT_BATCH_INTERVAL ms
+#define POINT_BATCH_INTERVAL 30
+/// ...or immediately when a channel collects POINT_BATCH_MAX_SIZE points
+#define POINT_BATCH_MAX_SIZE 4096
+
+/// Number of samples summarized by one min/max block of the lowest plot decimation level
+#define DECIMATION_BASE_BLOCK 16
+/// Each higher decimation level merges DECIMATION_LEVEL_FACTOR blocks of the level below
+#define DECIMATION_LEVEL_FACTOR 8
+
+/// Number of samples in one block of the running measurement statistics
+#define MEASUREMENT_BLOCK_SIZE 4096
+/// Dominant frequency of the measured signal is recalculated once at least 1/MEASUREMENT_FREQ_REFRESH_RATIO of its samples changed
+#define MEASUREMENT_FREQ_REFRESH_RATIO 8
+
+/// Compiled expressions are evaluated in blocks of EXPRESSION_BLOCK_SIZE samples
+#define EXPRESSION_BLOCK_SIZE 256
+
+/// XY graph shows at most XY_MAX_POINTS points, longer signals are decimated
+#define XY_MAX_POINTS 100000
+/// Sinc resampling in XY mode uses Lanczos window spanning XY_LANCZOS_SIZE samples on each side
+#define XY_LANCZOS_SIZE 3
+
+/// Capture files are written in blocks of at least CAPTURE_WRITE_BUFFER bytes
+#define CAPTURE_WRITE_BUFFER (1 << 20)
+/// Replayed data is sent to the parser every CAPTURE_REPLAY_INTERVAL ms...
+#define CAPTURE_REPLAY_INTERVAL 10
+/// ...at most CAPTURE_REPLAY_MAX_BYTES bytes at once (limits the maximum replay speed)
+#define CAPTURE_REPLAY_MAX_BYTES (1 << 20)
+
+/// Received data waiting to be written by the recorder are limited to RECORDER_QUEUE_LIMIT bytes, more data are dropped
+#define RECORDER_QUEUE_LIMIT (64 << 20)
+/// Recording is split into segments of at most RECORDER_SEGMENT_SIZE bytes...
+#define RECORDER_SEGMENT_SIZE (256LL << 20)
+/// ...or RECORDER_SEGMENT_TIME seconds
+#define RECORDER_SEGMENT_TIME 3600
+/// The oldest segments are deleted so that the recording takes at most RECORDER_DISK_BUDGET bytes
+#define RECORDER_DISK_BUDGET (4LL << 30)
+
+/// Decoded samples waiting to be written by the logger are limited to LOGGER_QUEUE_LIMIT samples, more samples are dropped
+#define LOGGER_QUEUE_LIMIT (8 << 20)
+/// Logged CSV is written in blocks of at least LOGGER_BLOCK_SIZE bytes (and at least once a second)
+#define LOGGER_BLOCK_SIZE (1 << 20)
+/// Log is split into segments of at most LOGGER_SEGMENT_SIZE bytes...
+#define LOGGER_SEGMENT_SIZE (256LL << 20)
+/// ...or LOGGER_SEGMENT_TIME seconds
+#define LOGGER_SEGMENT_TIME 3600
+
+/// Exported CSV table is written to the file in chunks of CSV_EXPORT_CHUNK bytes
+#define CSV_EXPORT_CHUNK (1 << 20)
+/// Columns of the binary export are compressed in blocks of COLUMN_FILE_BLOCK_SAMPLES samples...
+#define COLUMN_FILE_BLOCK_SAMPLES 65536
+/// ...by zlib with compression level COLUMN_FILE_COMPRESSION (low level, so it keeps up with the disk)
+#define COLUMN_FILE_COMPRESSION 1
+/// Time is stored as t0 + i * dt if no sample differs from it by more than COLUMN_FILE_TIME_TOLERANCE * dt
+#define COLUMN_FILE_TIME_TOLERANCE 1e-6
+
 #define PLOT_ELEMENTS_MOUSE_DISTANCE 10
 #define TRACER_MOUSE_DISTANCE 20
 
@@ -50,7 +50,10 @@
 
 #include "communication/newserialparser.h"
 #include "communication/plotdata.h"
+#include "communication/rawrecorder.h"
+#include "communication/samplelogger.h"
 #include "communication/serialreader.h"
+#include "communication/tableexporter.h"
 #include "global.h"
 #include "mainwindow/mainwindow.h"
 #include "math/averager.h"
@@ -68,16 +71,21 @@ Q_DECLARE_METATYPE(MessageTarget::enumMessageTarget)
 Q_DECLARE_METATYPE(QSharedPointer<QVector<double>>);
 Q_DECLARE_METATYPE(QSharedPointer<QCPGraphDataContainer>);
 Q_DECLARE_METATYPE(QSharedPointer<QCPCurveDataContainer>);
+Q_DECLARE_METATYPE(ChannelSnapshot);
 Q_DECLARE_METATYPE(MathOperations::enumMathOperations);
+Q_DECLARE_METATYPE(AverageMode::enumAverageMode);
 Q_DECLARE_METATYPE(FFTWindow::enumFFTWindow);
 Q_DECLARE_METATYPE(FFTType::enumFFTType);
 Q_DECLARE_METATYPE(Cursors::enumCursors);
 Q_DECLARE_METATYPE(ValueType);
+Q_DECLARE_METATYPE(QSharedPointer<SampleBatch>);
 Q_DECLARE_METATYPE(QCPRange);
 Q_DECLARE_METATYPE(QSerialPort::DataBits);
 Q_DECLARE_METATYPE(QSerialPort::StopBits);
 Q_DECLARE_METATYPE(QSerialPort::Parity);
 Q_DECLARE_METATYPE(QSerialPort::FlowControl);
+Q_DECLARE_METATYPE(TableExporter::Column);
+Q_DECLARE_METATYPE(TableExporter::Format);
 
 int main(int argc, char *argv[]) {
   QGuiApplication::setAttribute(Qt::AA_DisableHighDpiScaling);
@@ -97,17 +105,24 @@ int main(int argc, char *argv[]) {
   qRegisterMetaType<QSharedPointer<QVector<double>>>();
   qRegisterMetaType<QSharedPointer<QCPGraphDataContainer>>();
   qRegisterMetaType<QSharedPointer<QCPCurveDataContainer>>();
+  qRegisterMetaType<QList<QSharedPointer<QCPGraphDataContainer>>>();
+  qRegisterMetaType<QList<int>>();
+  qRegisterMetaType<ChannelSnapshot>();
   qRegisterMetaType<MathOperations::enumMathOperations>();
+  qRegisterMetaType<AverageMode::enumAverageMode>();
   qRegisterMetaType<FFTWindow::enumFFTWindow>();
   qRegisterMetaType<FFTType::enumFFTType>();
   qRegisterMetaType<Cursors::enumCursors>();
   qRegisterMetaType<QPair<ValueType, QByteArray>>();
   qRegisterMetaType<QList<QPair<ValueType, QByteArray>>>();
+  qRegisterMetaType<QSharedPointer<SampleBatch>>();
   qRegisterMetaType<QCPRange>();
   qRegisterMetaType<QSerialPort::DataBits>();
   qRegisterMetaType<QSerialPort::StopBits>();
   qRegisterMetaType<QSerialPort::Parity>();
   qRegisterMetaType<QSerialPort::FlowControl>();
+  qRegisterMetaType<QVector<TableExporter::Column>>();
+  qRegisterMetaType<TableExporter::Format>();
 
   // Create instances of the main objects
   MainWindow mainWindow;
@@ -125,6 +140,9 @@ int main(int argc, char *argv[]) {
   SignalProcessing *signalProcessingFFT2 = new SignalProcessing();
   Interpolator *interpolator = new Interpolator();
   Averager *averager = new Averager();
+  RawRecorder *rawRecorder = new RawRecorder();
+  SampleLogger *sampleLogger = new SampleLogger();
+  TableExporter *tableExporter = new TableExporter();
 
   // Create threads
   // QThread plotDataThread;
@@ -135,6 +153,9 @@ int main(int argc, char *argv[]) {
   QThread interpolatorThread;
   QThread averagerThread;
   QThread xyThread;
+  QThread recorderThread;
+  QThread loggerThread;
+  QThread exportThread;
 
   // Connect signals
   QObject::connect(serial1, &SerialReader::sendData, serialParser, &NewSerialParser::parse);
@@ -181,6 +202,29 @@ int main(int argc, char *argv[]) {
   QObject::connect(&mainWindow, &MainWindow::setManualMessageLevel, serialParserM, &NewSerialParser::setMsgLevel);
   QObject::connect(&mainWindow, &MainWindow::beginSerialConnection, serial1, &SerialReader::begin);
   QObject::connect(&mainWindow, &MainWindow::toggleSerialConnection, serial1, &SerialReader::toggle);
+  QObject::connect(&mainWindow, &MainWindow::setReplay, serial1, &SerialReader::setReplay);
+  QObject::connect(&mainWindow, &MainWindow::startRecording, rawRecorder, &RawRecorder::start);
+  QObject::connect(&mainWindow, &MainWindow::stopRecording, rawRecorder, &RawRecorder::stop);
+  QObject::connect(rawRecorder, &RawRecorder::status, &mainWindow, &MainWindow::recorderStatus);
+  QObject::connect(rawRecorder, &RawRecorder::sendMessage, &mainWindow, &MainWindow::printMessage);
+  serial1->setRecorder(rawRecorder);
+  QObject::connect(&mainWindow, &MainWindow::startLogging, sampleLogger, &SampleLogger::start);
+  QObject::connect(&mainWindow, &MainWindow::stopLogging, sampleLogger, &SampleLogger::stop);
+  QObject::connect(sampleLogger, &SampleLogger::status, &mainWindow, &MainWindow::loggerStatus);
+  QObject::connect(sampleLogger, &SampleLogger::sendMessage, &mainWindow, &MainWindow::printMessage);
+  // Logger gets the same batches as the plot (or averager), only queues them in the parser thread
+  QObject::connect(plotData, &PlotData::addVectorToPlot, sampleLogger, &SampleLogger::append, Qt::DirectConnection);
+  QObject::connect(plotData, &PlotData::addPointsToPlot, sampleLogger, &SampleLogger::append, Qt::DirectConnection);
+  QObject::connect(plotData, &PlotData::pointsNotPlotted, sampleLogger, &SampleLogger::append, Qt::DirectConnection);
+  QObject::connect(plotData, &PlotData::addPointToAverager, sampleLogger, &SampleLogger::appendPoint, Qt::DirectConnection);
+  QObject::connect(plotData, &PlotData::addDataToAverager, sampleLogger, [sampleLogger](int chID, double, QSharedPointer<QCPGraphDataContainer> data) { sampleLogger->append(chID, data); }, Qt::DirectConnection);
+  QObject::connect(&mainWindow, &MainWindow::exportCSVToFile, tableExporter, &TableExporter::exportCSV);
+  QObject::connect(&mainWindow, &MainWindow::exportColumnFile, tableExporter, &TableExporter::exportColumnFile);
+  // Direct connection, export thread is busy exporting until it is canceled
+  QObject::connect(&mainWindow, &MainWindow::cancelExport, tableExporter, &TableExporter::cancel, Qt::DirectConnection);
+  QObject::connect(&mainWindow, &MainWindow::clearExportCancel, tableExporter, &TableExporter::clearCancel, Qt::DirectConnection);
+  QObject::connect(tableExporter, &TableExporter::progress, &mainWindow, &MainWindow::exportProgress);
+  QObject::connect(tableExporter, &TableExporter::finished, &mainWindow, &MainWindow::exportFinished);
   QObject::connect(&mainWindow, &MainWindow::disconnectSerial, serial1, &SerialReader::end);
   QObject::connect(&mainWindow, &MainWindow::resetChannels, plotData, &PlotData::reset);
   QObject::connect(&mainWindow, &MainWindow::writeToSerial, serial1, &SerialReader::write);
@@ -196,6 +240,9 @@ int main(int argc, char *argv[]) {
   QObject::connect(plotData, &PlotData::addMathData, plotMath, &PlotMath::addMathData);
   QObject::connect(&mainWindow, &MainWindow::setMathFirst, plotData, &PlotData::setMathFirst);
   QObject::connect(&mainWindow, &MainWindow::setMathSecond, plotData, &PlotData::setMathSecond);
+  QObject::connect(&mainWindow, &MainWindow::setMathExpressionInputs, plotData, &PlotData::setMathExpressionInputs);
+  QObject::connect(&mainWindow, &MainWindow::resetMathExpression, plotMath, &PlotMath::resetMathExpression);
+  QObject::connect(plotData, &PlotData::addMathExpressionData, plotMath, &PlotMath::addMathExpressionData);
   QObject::connect(&mainWindow, &MainWindow::clearMath, plotMath, &PlotMath::clearMath);
   QObject::connect(&mainWindow, &MainWindow::requstMeasurements1, signalProcessing1, &SignalProcessing::process);
   QObject::connect(&mainWindow, &MainWindow::requstMeasurements2, signalProcessing2, &SignalProcessing::process);
@@ -211,9 +258,12 @@ int main(int argc, char *argv[]) {
   QObject::connect(&mainWindow, &MainWindow::setAverager, plotData, &PlotData::setAverager);
   QObject::connect(&mainWindow, &MainWindow::resetAverager, averager, &Averager::reset);
   QObject::connect(&mainWindow, &MainWindow::setAveragerCount, averager, &Averager::setCount);
+  QObject::connect(&mainWindow, &MainWindow::setAveragerMode, averager, &Averager::setMode);
+  QObject::connect(&mainWindow, &MainWindow::setLogicTransitionsOnly, plotData, &PlotData::setLogicTransitionsOnly);
   QObject::connect(plotData, &PlotData::addDataToAverager, averager, &Averager::newDataVector);
   QObject::connect(plotData, &PlotData::addPointToAverager, averager, &Averager::newDataPoint);
   QObject::connect(&mainWindow, &MainWindow::setInterpolationFilter, interpolator, &Interpolator::loadFilterFromFile);
+  QObject::connect(&mainWindow, &MainWindow::setInterpolation, interpolator, &Interpolator::setInterpolation);
   QObject::connect(&mainWindow, &MainWindow::replyEcho, serialParser, &NewSerialParser::replyEcho);
   QObject::connect(&mainWindow, &MainWindow::changeSerialBaud, serial1, &SerialReader::changeBaud);
 
@@ -234,6 +284,9 @@ int main(int argc, char *argv[]) {
   signalProcessingFFT2->moveToThread(&signalProcessingFFT2Thread);
   interpolator->moveToThread(&interpolatorThread);
   averager->moveToThread(&averagerThread);
+  rawRecorder->moveToThread(&recorderThread);
+  sampleLogger->moveToThread(&loggerThread);
+  tableExporter->moveToThread(&exportThread);
 
   // Start threads
   serialReaderThread.start();
@@ -246,12 +299,18 @@ int main(int argc, char *argv[]) {
   interpolatorThread.start();
   averagerThread.start();
   xyThread.start();
+  recorderThread.start();
+  loggerThread.start();
+  exportThread.start();
 
   // Show the window and wait for it to close
   mainWindow.init(&translator, plotData, plotMath, serial1, averager);
   mainWindow.show();
   int returnValue = application.exec();
 
+  // Running export would block its thread from finishing
+  tableExporter->cancel();
+
   // Delete objects once their processes are finished
   serialParser->deleteLater();
   serialParserM->deleteLater();
@@ -265,6 +324,9 @@ int main(int argc, char *argv[]) {
   interpolator->deleteLater();
   averager->deleteLater();
   xyMode->deleteLater();
+  rawRecorder->deleteLater();
+  sampleLogger->deleteLater();
+  tableExporter->deleteLater();
 
   // Request event loop termination
   serialParserThread.quit();
@@ -277,6 +339,9 @@ int main(int argc, char *argv[]) {
   interpolatorThread.quit();
   averagerThread.quit();
   xyThread.quit();
+  recorderThread.quit();
+  loggerThread.quit();
+  exportThread.quit();
 
   // Wait for processes to finish
   serialParserThread.wait();
@@ -289,6 +354,9 @@ int main(int argc, char *argv[]) {
   interpolatorThread.wait();
   averagerThread.wait();
   xyThread.wait();
+  recorderThread.wait();
+  loggerThread.wait();
+  exportThread.wait();
 
   return returnValue;
 }
@@ -40,6 +40,8 @@ AppSettings::AppSettings(MainWindow *parent) : QObject{parent} {
   setables["rstcmd"] = {mainwindow->developerOptions->getUi()->lineEditResetCmd, true};
   setables["autoautoset"] = {mainwindow->developerOptions->getUi()->checkBoxAutoAutoSet, true};
   setables["nofreeze"] = {mainwindow->developerOptions->getUi()->checkBoxFreezeSafe, true};
+  setables["pointmem"] = {mainwindow->developerOptions->getUi()->spinBoxPointMemoryLimit, true};
+  setables["logicchanges"] = {mainwindow->developerOptions->getUi()->checkBoxLogicTransitionsOnly, true};
 }
 
 void AppSettings::applyGuiElementSettings(QWidget *target, QString value) {
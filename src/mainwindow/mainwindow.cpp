@@ -107,6 +107,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
   newItem2->setText(tr("Telnet"));
   newItem2->setData(Qt::UserRole, "~SPECIAL~TELNET");
   ui->listWidgetCom->addItem(newItem2);
+
+  auto newItem3 = new QListWidgetItem();
+  newItem3->setText(tr("Replay capture"));
+  newItem3->setData(Qt::UserRole, "~SPECIAL~REPLAY");
+  ui->listWidgetCom->addItem(newItem3);
 }
 
 void MainWindow::closeEvent(QCloseEvent *event) {
@@ -165,7 +170,7 @@ void MainWindow::init(QTranslator *translator, const PlotData *plotData, const P
 
   QObject::connect(plotMath, &PlotMath::sendResult, ui->plot, &MyMainPlot::newDataVector);
   QObject::connect(plotData, &PlotData::addVectorToPlot, ui->plot, &MyMainPlot::newDataVector);
-  QObject::connect(plotData, &PlotData::addPointToPlot, ui->plot, &MyMainPlot::newDataPoint);
+  QObject::connect(plotData, &PlotData::addPointsToPlot, ui->plot, &MyMainPlot::newDataPoints);
   QObject::connect(plotData, &PlotData::clearLogic, ui->plot, &MyMainPlot::clearLogicGroup);
   QObject::connect(&fileSender, &FileSender::transmit, serialReader, &SerialReader::write);
   QObject::connect(qmlTerminalInterface, &QmlTerminalInterface::dataTransmitted, serialReader, &SerialReader::write);
@@ -320,11 +325,42 @@ void MainWindow::printDeviceMessage(QByteArray message, bool warning, bool ended
 }
 
 void MainWindow::updateMathNow(int number) {
-  emit setMathFirst(number, mathEn[number - 1]->isChecked() ? mathFirst[number - 1]->currentIndex() + 1 : 0);
-  emit setMathSecond(number, mathEn[number - 1]->isChecked() ? mathSecond[number - 1]->currentIndex() + 1 : 0);
+  // Zadaný vzorec má přednost před výběrem kanálů a operace
+  QString expression = mathExpression[number - 1]->text().trimmed();
+  bool useExpression = mathEn[number - 1]->isChecked() && !expression.isEmpty();
+  bool expressionValid = false;
+  QList<int> expressionChannels;
+  if (useExpression) {
+    // Přeloží se i zde, aby šlo hned ukázat chybu a zjistit, které kanály vzorec používá
+    CompiledExpression compiled;
+    expressionValid = compiled.compile(expression, PlotMath::expressionVariables());
+    QString error = compiled.errorString();
+    for (int variable : compiled.usedVariables())
+      if (variable > 0)
+        expressionChannels.append(variable); // Proměnná chN má index N, index 0 je čas
+    if (expressionValid && expressionChannels.isEmpty()) {
+      expressionValid = false;
+      error = tr("Formula must use at least one channel (it is evaluated for samples of the channels it uses)");
+    }
+    if (!expressionValid) {
+      expressionChannels.clear();
+      printMessage(tr("Invalid formula of math %1").arg(number).toUtf8(), error.toUtf8(), MessageLevel::error, MessageTarget::manual);
+    }
+  }
+  mathExpression[number - 1]->setStyleSheet((useExpression && !expressionValid) ? "color: rgb(255, 0, 0);" : "");
+
+  bool useOperation = mathEn[number - 1]->isChecked() && !useExpression;
+  emit setMathFirst(number, useOperation ? mathFirst[number - 1]->currentIndex() + 1 : 0);
+  emit setMathSecond(number, useOperation ? mathSecond[number - 1]->currentIndex() + 1 : 0);
+  emit setMathExpressionInputs(number, expressionChannels);
   emit clearMath(number);
   ui->plot->clearCh(getAnalogChId(number, ChannelType::math));
-  if (mathEn[number - 1]->isChecked()) {
+  if (useExpression && expressionValid) {
+    QList<QSharedPointer<QCPGraphDataContainer>> inputs;
+    for (int ch : qAsConst(expressionChannels))
+      inputs.append(ui->plot->graph(getAnalogChId(ch, ChannelType::analog))->data());
+    emit resetMathExpression(number, expression, inputs);
+  } else if (useOperation) {
     MathOperations::enumMathOperations operation = (MathOperations::enumMathOperations)mathOp[number - 1]->currentIndex();
     QSharedPointer<QCPGraphDataContainer> in1, in2;
 
@@ -21,6 +21,7 @@
 #include <QElapsedTimer>
 #include <QMainWindow>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QQmlContext>
 #include <QQmlEngine>
 #include <QSerialPortInfo>
@@ -32,6 +33,7 @@
 #include "communication/filesender.h"
 #include "communication/serialreader.h"
 #include "communication/serialsettingsdialog.h"
+#include "communication/tableexporter.h"
 #include "developeroptions.h"
 #include "freqtimeplotdialog.h"
 #include "global.h"
@@ -39,6 +41,7 @@
 #include "mainwindow/updatechecker.h"
 #include "manualinputdialog.h"
 #include "math/averager.h"
+#include "math/channelsnapshot.h"
 #include "math/plotmath.h"
 #include "qml/ansiterminalmodel.h"
 #include "qml/messagemodel.h"
@@ -83,6 +86,7 @@ private:
   QComboBox *mathOp[3];
   QDoubleSpinBox *mathScalarFirst[3];
   QDoubleSpinBox *mathScalarSecond[3];
+  QLineEdit *mathExpression[3];
   QIcon iconRun, iconPause, iconHidden, iconVisible, iconConnected, iconNotConnected, iconCross, iconAbsoluteCursor, iconMaximize, iconUnMaximize;
   QString serialMonitor;
   QStringList consoleBuffer;
@@ -108,6 +112,7 @@ private:
   bool hasMaximizedPlot = false;
   UpdateChecker updateChecker;
   QString updateDownloadUrl;
+  QProgressDialog *exportDialog = nullptr;
 
   bool writeConfigInAppDirectory = false;
   QByteArray versionstring;
@@ -124,6 +129,8 @@ private:
   void updateChScale();
   void changeLanguage(QString code);
   void exportCSV(int ch);
+  void exportAllCSV();
+  int askExportTarget(QWidget *parent, QString name, bool offerColumnFile = false);
   void fillChannelSelect();
   void updateChannelComboBox(QComboBox &combobox, int numberOfExcludedAtEnd);
   void updateSelectedChannel(int arg1);
@@ -175,6 +182,7 @@ private slots:
   void pushButtonClearGraph_clicked();
   void checkBoxEchoReply_toggled(bool checked);
   void checkBoxMouseControls_toggled_new(bool checked);
+  void spinBoxPointMemoryLimit_valueChanged(int megabytes);
   void requestConfigFolderOpen();
 
 private slots: // Autoconnect slots
@@ -229,6 +237,9 @@ private slots: // Autoconnect slots
   void on_doubleSpinBoxMathScalar2_1_valueChanged(double) { updateMathNow(1); }
   void on_doubleSpinBoxMathScalar2_2_valueChanged(double) { updateMathNow(2); }
   void on_doubleSpinBoxMathScalar2_3_valueChanged(double) { updateMathNow(3); }
+  void on_lineEditMathExpression1_editingFinished() { updateMathNow(1); }
+  void on_lineEditMathExpression2_editingFinished() { updateMathNow(2); }
+  void on_lineEditMathExpression3_editingFinished() { updateMathNow(3); }
   void on_horizontalSliderXYGrid_valueChanged(int value);
   void on_pushButtonXY_toggled(bool checked);
   void on_comboBoxCursor1Channel_currentIndexChanged(int index) { on_comboBoxCursorXXXChannel_currentIndexChanged(1, index); }
@@ -268,6 +279,7 @@ private slots: // Autoconnect slots
   void on_spinBoxAvg_valueChanged(int arg1);
   void on_radioButtonAverageIndividual_toggled(bool checked);
   void on_comboBoxAvgIndividualCh_currentIndexChanged(int arg1);
+  void on_comboBoxAvgMode_currentIndexChanged(int index) { emit setAveragerMode((AverageMode::enumAverageMode)index); }
   void on_lineEditHUnit_textChanged(const QString &arg1);
   void on_pushButtonProtocolGuideCZ_clicked();
   void on_pushButtonProtocolGuideEN_clicked();
@@ -288,6 +300,7 @@ private slots: // Autoconnect slots
   void on_pushButtonFvsT_clicked();
   void on_pushButtonSerialMonitor_toggled(bool checked);
   void on_comboBoxXYStyle_currentIndexChanged(int index);
+  void on_spinBoxXYPersistence_valueChanged(int arg1) { ui->plotxy->setPersistence(arg1); }
   void on_comboBoxFFTStyle1_currentIndexChanged(int index);
   void on_comboBoxFFTStyle2_currentIndexChanged(int index);
   void on_pushButtonModeRolling_clicked();
@@ -296,6 +309,8 @@ private slots: // Autoconnect slots
   void on_doubleSpinBoxViewCenter_valueChanged(double arg1);
   void on_dialZoom_valueChanged(int position);
   void on_listWidgetCom_itemClicked(QListWidgetItem *item);
+  void on_pushButtonRecord_toggled(bool checked);
+  void on_pushButtonLog_toggled(bool checked);
   void on_pushButtonRollingAutoRange_toggled(bool checked);
   void on_pushButtonFFT_Maximize_clicked();
   void on_pushButtonXY_Maximize_clicked();
@@ -336,6 +351,10 @@ public slots:
   void setQmlProperty(QByteArray data);
   void loadQmlFile(QUrl url);
   void dataRateUpdate(int dataUpdates);
+  void recorderStatus(bool recording, qint64 written, qint64 dropped, qint64 rate, QString fileName);
+  void loggerStatus(bool logging, qint64 written, qint64 backlog, qint64 dropped, qint64 rate, QString fileName);
+  void exportProgress(int percent);
+  void exportFinished(bool success, QString fileName, QString error);
   void mainPlotHRangeChanged(QCPRange range);
   void mainPlotHRangeMaxChanged(QCPRange range);
   void mainPlotVRangeChanged(QCPRange range);
@@ -351,6 +370,15 @@ signals:
   void requestManualBufferClear();
   void requestManualBufferShow();
   void beginSerialConnection(QString port, int baud, QSerialPort::DataBits dataBits, QSerialPort::Parity parity, QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControll);
+  void setReplay(QString fileName, double speed);
+  void startRecording(QString baseName, qint64 segmentSize, int segmentSeconds, qint64 diskBudget);
+  void stopRecording();
+  void startLogging(QString baseName, bool binary, TableExporter::Format format, qint64 segmentSize, int segmentSeconds);
+  void stopLogging();
+  void exportCSVToFile(QString fileName, QVector<TableExporter::Column> columns, TableExporter::Format format);
+  void exportColumnFile(QString fileName, QVector<TableExporter::Column> columns);
+  void cancelExport();
+  void clearExportCancel();
   void toggleSerialConnection(QString port, int baud, QSerialPort::DataBits dataBits, QSerialPort::Parity parity, QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControll);
   void writeToSerial(QByteArray data);
   void resetChannels();
@@ -364,16 +392,20 @@ signals:
   void setMathSecond(int math, int ch);
   void clearMath(int math);
   void resetMath(int mathNumber, MathOperations::enumMathOperations mode, QSharedPointer<QCPGraphDataContainer> in1, QSharedPointer<QCPGraphDataContainer> in2, bool firstIsConst, bool secondIsConst, double scaleFirst, double scaleSecond);
-  void requestXY(QSharedPointer<QCPGraphDataContainer> in1, QSharedPointer<QCPGraphDataContainer> in2, bool removeDC);
-  void requstMeasurements1(QSharedPointer<QCPGraphDataContainer> data);
-  void requstMeasurements2(QSharedPointer<QCPGraphDataContainer> data);
-  void requestFFT1(QSharedPointer<QCPGraphDataContainer> data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int pWelchtimeDivisions, bool twosided, bool zerocenter, int minNFFT);
-  void requestFFT2(QSharedPointer<QCPGraphDataContainer> data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int pWelchtimeDivisions, bool twosided, bool zerocenter, int minNFFT);
+  void setMathExpressionInputs(int math, QList<int> channels);
+  void resetMathExpression(int mathNumber, QString expression, QList<QSharedPointer<QCPGraphDataContainer>> inputs);
+  void requestXY(ChannelSnapshot in1, ChannelSnapshot in2, bool removeDC, bool sincResampling);
+  void requstMeasurements1(ChannelSnapshot data);
+  void requstMeasurements2(ChannelSnapshot data);
+  void requestFFT1(ChannelSnapshot data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int pWelchtimeDivisions, bool twosided, bool zerocenter, int minNFFT);
+  void requestFFT2(ChannelSnapshot data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int pWelchtimeDivisions, bool twosided, bool zerocenter, int minNFFT);
   void setInterpolation(int chID, bool enabled);
   void interpolate(int chID, const QSharedPointer<QCPGraphDataContainer> data, QCPRange visibleRange, bool dataIsFromInterpolationBuffer);
   void resetAverager();
   void setAverager(bool enabled);
   void setAveragerCount(int chID, int count);
+  void setAveragerMode(AverageMode::enumAverageMode mode);
+  void setLogicTransitionsOnly(bool enabled);
   void setInterpolationFilter(QString filename, int upsampling);
   void replyEcho(bool enabled);
   void changeSerialBaud(qint32 baud);
@@ -16,44 +16,55 @@
 #include "defaultpathmanager.h"
 #include "mainwindow.h"
 #include "ui_freqtimeplotdialog.h"
+#include <QBuffer>
+
+int MainWindow::askExportTarget(QWidget *parent, QString name, bool offerColumnFile) {
+  QMessageBox msgBox(parent);
+  msgBox.setText(tr("Export %1 as table").arg(name));
+  msgBox.setIcon(QMessageBox::Question);
+  msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::Ok | QMessageBox::Cancel | (offerColumnFile ? QMessageBox::Save : QMessageBox::NoButton));
+  msgBox.setDefaultButton(QMessageBox::Yes);
+  msgBox.setButtonText(QMessageBox::Yes, tr("To clipboard"));
+  msgBox.setButtonText(QMessageBox::Ok, tr("To CSV file"));
+  if (offerColumnFile)
+    msgBox.setButtonText(QMessageBox::Save, tr("To binary file"));
+  return msgBox.exec();
+}
 
 void MainWindow::exportCSV(int ch) {
+  if (ch == EXPORT_ALL) {
+    exportAllCSV();
+    return;
+  }
+
   QString name = "";
-  if (ch == EXPORT_ALL)
-    name = tr("all");
+  if (ch == EXPORT_FFT)
+    name = "fft";
+  else if (ch == EXPORT_XY)
+    name = "xy";
+  else if (ch == EXPORT_FREQTIME)
+    name = "freqTime";
+  else if (ch == ANALOG_COUNT + MATH_COUNT + LOGIC_GROUPS - 1)
+    name = tr("logic");
+  else if (ch >= ANALOG_COUNT + MATH_COUNT)
+    name = tr("logic %1").arg(ch - ANALOG_COUNT - MATH_COUNT + 1);
   else {
-    if (ch == EXPORT_FFT)
-      name = "fft";
-    else if (ch == EXPORT_XY)
-      name = "xy";
-    else if (ch == EXPORT_FREQTIME)
-      name = "freqTime";
-    else if (ch == ANALOG_COUNT + MATH_COUNT + LOGIC_GROUPS - 1)
-      name = tr("logic");
-    else if (ch >= ANALOG_COUNT + MATH_COUNT)
-      name = tr("logic %1").arg(ch - ANALOG_COUNT - MATH_COUNT + 1);
-    else {
-      name = getChName(ch);
-    }
+    name = getChName(ch);
   }
 
   QByteArray data;
   char decimal = ui->radioButtonCSVDot->isChecked() ? '.' : ',';
   char separator = ui->radioButtonCSVDot->isChecked() ? ',' : ';';
-  if (ch == EXPORT_ALL)
-    data = (ui->plot->exportAllCSV(separator, decimal, ui->spinBoxCSVPrecision->value(), ui->checkBoxCSVVRO->isChecked(), ui->checkBoxCSVIncludeHidden->isChecked()));
-  else {
-    if (ch >= ANALOG_COUNT + MATH_COUNT)
-      data = (ui->plot->exportLogicCSV(separator, decimal, ch - ANALOG_COUNT - MATH_COUNT, ui->spinBoxCSVPrecision->value(), ui->checkBoxCSVVRO->isChecked()));
-    else if (ch == EXPORT_XY)
-      data = (ui->plotxy->exportCSV(separator, decimal, ui->spinBoxCSVPrecision->value()));
-    else if (ch == EXPORT_FREQTIME)
-      data = (freqTimePlotDialog->getUi()->plotPeak->exportCSV(separator, decimal, ui->spinBoxCSVPrecision->value()));
-    else if (ch == EXPORT_FFT)
-      data = (ui->plotFFT->exportCSV(separator, decimal, ui->spinBoxCSVPrecision->value()));
-    else
-      data = (ui->plot->exportChannelCSV(separator, decimal, ch, ui->spinBoxCSVPrecision->value(), ui->checkBoxCSVVRO->isChecked()));
-  }
+  if (ch >= ANALOG_COUNT + MATH_COUNT)
+    data = (ui->plot->exportLogicCSV(separator, decimal, ch - ANALOG_COUNT - MATH_COUNT, ui->spinBoxCSVPrecision->value(), ui->checkBoxCSVVRO->isChecked()));
+  else if (ch == EXPORT_XY)
+    data = (ui->plotxy->exportCSV(separator, decimal, ui->spinBoxCSVPrecision->value()));
+  else if (ch == EXPORT_FREQTIME)
+    data = (freqTimePlotDialog->getUi()->plotPeak->exportCSV(separator, decimal, ui->spinBoxCSVPrecision->value()));
+  else if (ch == EXPORT_FFT)
+    data = (ui->plotFFT->exportCSV(separator, decimal, ui->spinBoxCSVPrecision->value()));
+  else
+    data = (ui->plot->exportChannelCSV(separator, decimal, ch, ui->spinBoxCSVPrecision->value(), ui->checkBoxCSVVRO->isChecked()));
 
   if (data.isEmpty()) {
     QMessageBox msgBox(this);
@@ -64,14 +75,7 @@ void MainWindow::exportCSV(int ch) {
   }
 
   QWidget *dialogParent = (ch == EXPORT_FREQTIME) ? static_cast<QWidget *>(freqTimePlotDialog) : this;
-  QMessageBox msgBox(dialogParent);
-  msgBox.setText(tr("Export %1 as table").arg(name));
-  msgBox.setIcon(QMessageBox::Question);
-  msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::Ok | QMessageBox::Cancel);
-  msgBox.setDefaultButton(QMessageBox::Yes);
-  msgBox.setButtonText(QMessageBox::Yes, tr("To clipboard"));
-  msgBox.setButtonText(QMessageBox::Ok, tr("To CSV file"));
-  int returnValue = msgBox.exec();
+  int returnValue = askExportTarget(dialogParent, name);
   if (returnValue == QMessageBox::Cancel) // Okno bylo zavřeno křížkem
     return;
   bool toClipboard = (returnValue == QMessageBox::Yes);
@@ -95,6 +99,80 @@ void MainWindow::exportCSV(int ch) {
   }
 }
 
+void MainWindow::exportAllCSV() {
+  if (exportDialog != nullptr) // Předchozí export ještě běží
+    return;
+
+  TableExporter::Format format;
+  format.decimal = ui->radioButtonCSVDot->isChecked() ? '.' : ',';
+  format.separator = ui->radioButtonCSVDot->isChecked() ? ',' : ';';
+  format.precision = ui->spinBoxCSVPrecision->value();
+
+  // Sloupce jsou snímky kanálů (viz MyMainPlot::snapshot), tabulka se skládá až při zápisu v jiném vlákně
+  QVector<TableExporter::Column> columns = ui->plot->exportAllColumns(ui->checkBoxCSVVRO->isChecked(), ui->checkBoxCSVIncludeHidden->isChecked());
+  if (columns.isEmpty()) {
+    QMessageBox msgBox(this);
+    msgBox.setText(tr("No data to export"));
+    msgBox.setIcon(QMessageBox::Warning);
+    msgBox.exec();
+    return;
+  }
+
+  QString name = tr("all");
+  int returnValue = askExportTarget(this, name, true);
+  if (returnValue == QMessageBox::Cancel) // Okno bylo zavřeno křížkem
+    return;
+
+  if (returnValue == QMessageBox::Yes) {
+    // Schránka potřebuje celý text najednou
+    QBuffer buffer;
+    buffer.open(QBuffer::WriteOnly);
+    TableExporter exporter;
+    format.separator = '\t'; // V Excelovském formátu tabulky jsou hodnoty oddělené tabulátory
+    exporter.writeCSV(buffer, columns, format);
+    QClipboard *clipboard = QGuiApplication::clipboard();
+    clipboard->setText(buffer.data());
+  } else {
+    bool columnFile = (returnValue == QMessageBox::Save);
+    QString defaultName = QString(columnFile ? "%1.dpcol" : "%1.csv").arg(name);
+    QString filter = columnFile ? tr("Binary column file (*.dpcol)") : tr("Comma separated values (*.csv)");
+    QString fileName = DefaultPathManager::getInstance().requestSaveFile(this, tr("Export %1").arg(name), "path_export", defaultName, filter);
+    if (fileName.isEmpty())
+      return;
+
+    // Zápis běží v jiném vlákně, okno průběhu ho umožní zrušit
+    exportDialog = new QProgressDialog(tr("Exporting %1").arg(QFileInfo(fileName).fileName()), tr("Cancel"), 0, 100, this);
+    exportDialog->setWindowModality(Qt::WindowModal);
+    exportDialog->setMinimumDuration(500);
+    exportDialog->setAutoClose(false);
+    exportDialog->setAutoReset(false);
+    connect(exportDialog, &QProgressDialog::canceled, this, &MainWindow::cancelExport);
+    exportDialog->setValue(0);
+    emit clearExportCancel();
+    if (columnFile)
+      emit exportColumnFile(fileName, columns);
+    else
+      emit exportCSVToFile(fileName, columns, format);
+  }
+}
+
+void MainWindow::exportProgress(int percent) {
+  if (exportDialog != nullptr)
+    exportDialog->setValue(percent);
+}
+
+void MainWindow::exportFinished(bool success, QString fileName, QString error) {
+  if (exportDialog != nullptr) {
+    bool canceled = exportDialog->wasCanceled();
+    exportDialog->deleteLater();
+    exportDialog = nullptr;
+    if (canceled)
+      return;
+  }
+  if (!success)
+    qCritical() << "Cannot write to file" << fileName << error;
+}
+
 void MainWindow::on_pushButtonPlotImage_clicked() {
   QMessageBox msgBox(this);
   msgBox.setText(tr("Export main plot as image"));
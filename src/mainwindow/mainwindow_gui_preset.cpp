@@ -76,6 +76,8 @@ void MainWindow::connectSignals() {
   connect(developerOptions->getUi()->pushButtonClearGraph, &QPushButton::clicked, this, &MainWindow::pushButtonClearGraph_clicked);
   connect(developerOptions->getUi()->checkBoxEchoReply, &QCheckBox::toggled, this, &MainWindow::checkBoxEchoReply_toggled);
   connect(developerOptions->getUi()->checkBoxMouseControls, &QCheckBox::toggled, this, &MainWindow::checkBoxMouseControls_toggled_new);
+  connect(developerOptions->getUi()->spinBoxPointMemoryLimit, SIGNAL(valueChanged(int)), this, SLOT(spinBoxPointMemoryLimit_valueChanged(int)));
+  connect(developerOptions->getUi()->checkBoxLogicTransitionsOnly, &QCheckBox::toggled, this, &MainWindow::setLogicTransitionsOnly);
   connect(freqTimePlotDialog, &FreqTimePlotDialog::requestedCSVExport, this, &MainWindow::exportCSV);
   connect(developerOptions, &DeveloperOptions::sendManualInput, this, &MainWindow::sendManualInput);
   connect(developerOptions, &DeveloperOptions::requestManualBufferClear, this, &MainWindow::requestManualBufferClear);
@@ -182,6 +184,8 @@ void MainWindow::setGuiDefaults() {
 
   developerOptions->getUi()->checkBoxTriggerLineEn->setCheckState(Qt::PartiallyChecked);
 
+  spinBoxPointMemoryLimit_valueChanged(developerOptions->getUi()->spinBoxPointMemoryLimit->value());
+
   ui->comboBoxFIR->setCurrentIndex(0);
   on_comboBoxFIR_currentIndexChanged(0); // Interpolátor načte filtr
 
@@ -217,6 +221,10 @@ void MainWindow::setGuiArrays() {
   mathScalarSecond[0] = ui->doubleSpinBoxMathScalar2_1;
   mathScalarSecond[1] = ui->doubleSpinBoxMathScalar2_2;
   mathScalarSecond[2] = ui->doubleSpinBoxMathScalar2_3;
+
+  mathExpression[0] = ui->lineEditMathExpression1;
+  mathExpression[1] = ui->lineEditMathExpression2;
+  mathExpression[2] = ui->lineEditMathExpression3;
 }
 
 void MainWindow::fillChannelSelect() {
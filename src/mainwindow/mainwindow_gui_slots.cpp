@@ -13,8 +13,10 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include "defaultpathmanager.h"
 #include "mainwindow.h"
 #include "ui_freqtimeplotdialog.h"
+#include <QInputDialog>
 
 void MainWindow::setPlotLayout(QString type) {
   bool fft = ui->pushButtonFFT->isChecked();
@@ -491,6 +493,8 @@ void MainWindow::checkBoxMouseControls_toggled_new(bool checked) {
   freqTimePlotDialog->getUi()->plotPeak->enableMouseCursorControll(checked);
 }
 
+void MainWindow::spinBoxPointMemoryLimit_valueChanged(int megabytes) { ui->plot->setPointCapacity((int)((qint64)megabytes * 1024 * 1024 / sizeof(QCPGraphData))); }
+
 void MainWindow::requestConfigFolderOpen() { QDesktopServices::openUrl(QUrl::fromLocalFile(configFilePath.left(configFilePath.lastIndexOf("/")))); }
 
 void MainWindow::on_checkBoxFFTCh1_toggled(bool checked) {
@@ -626,6 +630,100 @@ void MainWindow::on_listWidgetCom_itemClicked(QListWidgetItem *item) {
     simulatedInputDialog->open();
   else
     simulatedInputDialog->close();
+
+  if (item->data(Qt::UserRole) == "~SPECIAL~REPLAY") {
+    QString fileName = DefaultPathManager::getInstance().requestOpenFile(this, tr("Replay capture"), "path_capture", tr("Capture file (*.dpcap)"));
+    if (fileName.isEmpty())
+      return;
+    QStringList speeds = {tr("Real time"), "2x", "10x", "100x", tr("Maximum")};
+    const double speedValues[] = {1, 2, 10, 100, 0};
+    bool ok;
+    QString speed = QInputDialog::getItem(this, tr("Replay capture"), tr("Speed"), speeds, 0, false, &ok);
+    if (!ok)
+      return;
+    emit setReplay(fileName, speedValues[speeds.indexOf(speed)]);
+    SerialSettingsDialog::Settings settings = serialSettingsDialog->settings();
+    emit beginSerialConnection(item->data(Qt::UserRole).toString(), ui->comboBoxBaud->currentText().toInt(), settings.dataBits, settings.parity, settings.stopBits, settings.flowControl);
+  }
+}
+
+void MainWindow::on_pushButtonRecord_toggled(bool checked) {
+  if (!checked) {
+    emit stopRecording();
+    return;
+  }
+  QString fileName = DefaultPathManager::getInstance().requestSaveFile(this, tr("Record received data"), "path_capture", "capture", tr("Capture file (*.dpcap)"));
+  if (fileName.isEmpty()) {
+    ui->pushButtonRecord->blockSignals(true);
+    ui->pushButtonRecord->setChecked(false);
+    ui->pushButtonRecord->blockSignals(false);
+    return;
+  }
+  // Segmenty se číslují, zvolený název je jen základ
+  QFile::remove(fileName); // Prázdný soubor vytvořený dialogem
+  if (fileName.endsWith(".dpcap"))
+    fileName.chop(6);
+  emit startRecording(fileName, RECORDER_SEGMENT_SIZE, RECORDER_SEGMENT_TIME, RECORDER_DISK_BUDGET);
+}
+
+void MainWindow::recorderStatus(bool recording, qint64 written, qint64 dropped, qint64 rate, QString fileName) {
+  if (!recording) {
+    ui->pushButtonRecord->blockSignals(true);
+    ui->pushButtonRecord->setChecked(false);
+    ui->pushButtonRecord->blockSignals(false);
+    ui->labelRecorderStatus->clear();
+    return;
+  }
+  QString text = tr("%1: %2, %3").arg(fileName, floatToNiceString(written, 3, false, false, false, UnitOfMeasure("-B")), floatToNiceString(rate, 3, false, false, false, UnitOfMeasure("-B/s")));
+  if (dropped > 0)
+    text.append(tr(", dropped %1").arg(floatToNiceString(dropped, 3, false, false, false, UnitOfMeasure("-B"))));
+  ui->labelRecorderStatus->setText(text);
+  ui->labelRecorderStatus->setStyleSheet(dropped > 0 ? "color: rgb(255, 0, 0);" : "");
+}
+
+void MainWindow::on_pushButtonLog_toggled(bool checked) {
+  if (!checked) {
+    emit stopLogging();
+    return;
+  }
+  QString fileName = DefaultPathManager::getInstance().requestSaveFile(this, tr("Log decoded samples"), "path_log", "log", tr("Comma separated values (*.csv);;Capture file (*.dpcap)"));
+  if (fileName.isEmpty()) {
+    ui->pushButtonLog->blockSignals(true);
+    ui->pushButtonLog->setChecked(false);
+    ui->pushButtonLog->blockSignals(false);
+    return;
+  }
+  // Segmenty se číslují, zvolený název je jen základ
+  QFile::remove(fileName); // Prázdný soubor vytvořený dialogem
+  bool binary = fileName.endsWith(".dpcap");
+  if (binary)
+    fileName.chop(6);
+  else if (fileName.endsWith(".csv"))
+    fileName.chop(4);
+
+  // CSV má stejný formát jako export
+  TableExporter::Format format;
+  format.decimal = ui->radioButtonCSVDot->isChecked() ? '.' : ',';
+  format.separator = ui->radioButtonCSVDot->isChecked() ? ',' : ';';
+  format.precision = ui->spinBoxCSVPrecision->value();
+  emit startLogging(fileName, binary, format, LOGGER_SEGMENT_SIZE, LOGGER_SEGMENT_TIME);
+}
+
+void MainWindow::loggerStatus(bool logging, qint64 written, qint64 backlog, qint64 dropped, qint64 rate, QString fileName) {
+  if (!logging) {
+    ui->pushButtonLog->blockSignals(true);
+    ui->pushButtonLog->setChecked(false);
+    ui->pushButtonLog->blockSignals(false);
+    ui->labelLoggerStatus->clear();
+    return;
+  }
+  QString text = tr("%1: %2, %3").arg(fileName, floatToNiceString(written, 3, false, false, false, UnitOfMeasure("-Sa")), floatToNiceString(rate, 3, false, false, false, UnitOfMeasure("-Sa/s")));
+  if (backlog > 0)
+    text.append(tr(", waiting %1").arg(floatToNiceString(backlog, 3, false, false, false, UnitOfMeasure("-Sa"))));
+  if (dropped > 0)
+    text.append(tr(", dropped %1").arg(floatToNiceString(dropped, 3, false, false, false, UnitOfMeasure("-Sa"))));
+  ui->labelLoggerStatus->setText(text);
+  ui->labelLoggerStatus->setStyleSheet(dropped > 0 ? "color: rgb(255, 0, 0);" : "");
 }
 
 void MainWindow::on_pushButtonFFT_Maximize_clicked() { plotMaximizeButtonClicked("fft"); }
@@ -139,12 +139,11 @@ void MainWindow::updateMeasurements1() {
     int chid = ui->comboBoxMeasure1->currentIndex();
     if (ui->plot->graph(chid)->data()->isEmpty())
       goto empty;
-    auto data = QSharedPointer<QCPGraphDataContainer>(
-        new QCPGraphDataContainer(*ui->plot->graph(chid)->data()));
-    if (ui->radioButtonSigPart->isChecked()) {
-      data->removeBefore(ui->plot->xAxis->range().lower);
-      data->removeAfter(ui->plot->xAxis->range().upper);
-    }
+    ChannelSnapshot data = ui->plot->snapshot(chid);
+    if (ui->radioButtonSigPart->isChecked())
+      data.limitRange(ui->plot->xAxis->range());
+    if (data.isEmpty())
+      goto empty;
     measureRefreshTimer1.stop();
     emit requstMeasurements1(data);
   } else {
@@ -171,12 +170,11 @@ void MainWindow::updateMeasurements2() {
     int chid = ui->comboBoxMeasure2->currentIndex();
     if (ui->plot->graph(chid)->data()->isEmpty())
       goto empty;
-    auto data = QSharedPointer<QCPGraphDataContainer>(
-        new QCPGraphDataContainer(*ui->plot->graph(chid)->data()));
-    if (ui->radioButtonSigPart->isChecked()) {
-      data->removeBefore(ui->plot->xAxis->range().lower);
-      data->removeAfter(ui->plot->xAxis->range().upper);
-    }
+    ChannelSnapshot data = ui->plot->snapshot(chid);
+    if (ui->radioButtonSigPart->isChecked())
+      data.limitRange(ui->plot->xAxis->range());
+    if (data.isEmpty())
+      goto empty;
     measureRefreshTimer2.stop();
     emit requstMeasurements2(data);
   } else {
@@ -202,20 +200,17 @@ void MainWindow::updateFFT1() {
   if (ui->checkBoxFFTCh1->isChecked()) {
     int chid = ui->comboBoxFFTCh1->currentIndex();
 
-    auto data = QSharedPointer<QCPGraphDataContainer>(
-        new QCPGraphDataContainer(*ui->plot->graph(chid)->data()));
-    if (ui->radioButtonFFTPart->isChecked()) {
-      data->removeBefore(ui->plot->xAxis->range().lower);
-      data->removeAfter(ui->plot->xAxis->range().upper);
-    }
+    ChannelSnapshot data = ui->plot->snapshot(chid);
+    if (ui->radioButtonFFTPart->isChecked())
+      data.limitRange(ui->plot->xAxis->range());
 
-    if (data->isEmpty()) {
+    if (data.isEmpty()) {
       ui->plotFFT->clear(0);
       return;
     }
 
     if (ui->comboBoxFFTType->currentIndex() == FFTType::pwelch) {
-      if (ui->spinBoxFFTSegments1->value() * 2 > data->size()) {
+      if (ui->spinBoxFFTSegments1->value() * 2 > data.size()) {
         // Není dostatek vzorků na tento počet segmentů (alespoň 2 na segment)
         ui->plotFFT->clear(0);
         return;
@@ -257,20 +252,17 @@ void MainWindow::updateFFT2() {
   if (ui->checkBoxFFTCh2->isChecked()) {
     int chid = ui->comboBoxFFTCh2->currentIndex();
 
-    auto data = QSharedPointer<QCPGraphDataContainer>(
-        new QCPGraphDataContainer(*ui->plot->graph(chid)->data()));
-    if (ui->radioButtonFFTPart->isChecked()) {
-      data->removeBefore(ui->plot->xAxis->range().lower);
-      data->removeAfter(ui->plot->xAxis->range().upper);
-    }
+    ChannelSnapshot data = ui->plot->snapshot(chid);
+    if (ui->radioButtonFFTPart->isChecked())
+      data.limitRange(ui->plot->xAxis->range());
 
-    if (data->isEmpty()) {
+    if (data.isEmpty()) {
       ui->plotFFT->clear(1);
       return;
     }
 
     if (ui->comboBoxFFTType->currentIndex() == FFTType::pwelch) {
-      if (ui->spinBoxFFTSegments2->value() * 2 > data->size()) {
+      if (ui->spinBoxFFTSegments2->value() * 2 > data.size()) {
         // Není dostatek vzorků na tento počet segmentů (alespoň 2 na segment)
         ui->plotFFT->clear(1);
         return;
@@ -409,22 +401,18 @@ void MainWindow::dataRateUpdate(int dataUpdates) {
 
 void MainWindow::updateXY() {
   if (ui->pushButtonXY->isChecked()) {
-    auto in1 = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer(
-        *ui->plot->graph(ui->comboBoxXYx->currentIndex())->data()));
-    auto in2 = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer(
-        *ui->plot->graph(ui->comboBoxXYy->currentIndex())->data()));
+    ChannelSnapshot in1 = ui->plot->snapshot(ui->comboBoxXYx->currentIndex());
+    ChannelSnapshot in2 = ui->plot->snapshot(ui->comboBoxXYy->currentIndex());
     if (ui->radioButtonXYPart->isChecked()) {
-      in1->removeBefore(ui->plot->xAxis->range().lower);
-      in1->removeAfter(ui->plot->xAxis->range().upper);
-      in2->removeBefore(ui->plot->xAxis->range().lower);
-      in2->removeAfter(ui->plot->xAxis->range().upper);
+      in1.limitRange(ui->plot->xAxis->range());
+      in2.limitRange(ui->plot->xAxis->range());
     }
-    if (in2->isEmpty() || in1->isEmpty()) {
+    if (in2.isEmpty() || in1.isEmpty()) {
       ui->plotxy->clear();
       return;
     }
 
     xyTimer.stop();
-    emit requestXY(in1, in2, ui->checkBoxXYNoDC->isChecked());
+    emit requestXY(in1, in2, ui->checkBoxXYNoDC->isChecked(), ui->comboBoxXYResampling->currentIndex() == 1);
   }
 }
@@ -90,9 +90,13 @@ void ManualInputDialog::rollingDataTimerRoutine() {
   rollingTimestamp += static_cast<double>(rollingTimer.interval()) / 1000.0 * ui->doubleSpinBoxTimeScale->value();
   QString data = "$$P" + QString::number(rollingTimestamp, 'g', 10);
   rollingEngine.globalObject().setProperty("t", rollingTimestamp);
-  for (auto &ch : rollingChannelEvaluators) {
-    bool isOk;
-    double val = ch->evaluate(rollingEngine, &isOk);
+  for (int i = 0; i < rollingChannelEvaluators.size(); i++) {
+    bool isOk = true;
+    double val;
+    if (rollingChannelPrograms.at(i)->isValid())
+      val = rollingChannelPrograms.at(i)->evaluate(QVector<double>{rollingTimestamp});
+    else
+      val = rollingChannelEvaluators.at(i)->evaluate(rollingEngine, &isOk);
     if (isOk)
       data.append("," + QString::number(val));
     else
@@ -107,18 +111,38 @@ void ManualInputDialog::oscDataTimerRoutine() {
   int len = ui->spinBoxOscLen->value();
   double fs = ui->doubleSpinBoxOscFs->value() * 1000;
   oscEngine.globalObject().setProperty("time", oscTimestamp);
-  int chnum = 1;
-  for (auto &ch : oscChannelEvaluators) {
-    bool isOk;
+
+  // Časy vzorků jsou pro všechny kanály stejné, "time" je v rámci jednoho průběhu konstantní (krok 0)
+  oscTimes.resize(len);
+  for (int i = 0; i < len; i++)
+    oscTimes[i] = static_cast<double>(i) / fs;
+  QVector<CompiledExpression::Variable> variables(2);
+  variables[0] = {oscTimes.constData(), 1};
+  variables[1] = {&oscTimestamp, 0};
+
+  for (int chIndex = 0; chIndex < oscChannelEvaluators.size(); chIndex++) {
+    bool isOk = true;
     QByteArray data = "$$C";
-    data.append(QString::number(chnum++).toLocal8Bit() + ",");
+    data.append(QString::number(chIndex + 1).toLocal8Bit() + ",");
     data.append(QString::number(1.0 / fs).toLocal8Bit() + ",");
     data.append(QString::number(len).toLocal8Bit() + ";f4");
 
-    for (int i = 0; i < len; i++) {
-      oscEngine.globalObject().setProperty("t", static_cast<double>(i) / fs);
-      float value = ch->evaluate(oscEngine, &isOk);
-      data.append(reinterpret_cast<char *>(&value), 4);
+    CompiledExpression *program = oscChannelPrograms.at(chIndex);
+    if (program->isValid()) {
+      // Každý průběh začíná od t = 0, klouzavé průměry proto nenavazují na předchozí
+      program->reset();
+      oscValues.resize(len);
+      program->evaluate(variables, len, oscValues.data());
+      oscSamples.resize(len);
+      for (int i = 0; i < len; i++)
+        oscSamples[i] = oscValues.at(i);
+      data.append(reinterpret_cast<const char *>(oscSamples.constData()), len * 4);
+    } else {
+      for (int i = 0; i < len; i++) {
+        oscEngine.globalObject().setProperty("t", static_cast<double>(i) / fs);
+        float value = oscChannelEvaluators.at(chIndex)->evaluate(oscEngine, &isOk);
+        data.append(reinterpret_cast<char *>(&value), 4);
+      }
     }
 
     data.append(";");
@@ -127,11 +151,22 @@ void ManualInputDialog::oscDataTimerRoutine() {
   }
 }
 
+bool ManualInputDialog::compileGenerator(CompiledExpression *program, const QString &expression, const QStringList &variables) {
+  // V JavaScriptu je ^ XOR, přeložený výraz ho bere jako mocninu. Výraz s ^ proto vždy počítá QJSEngine,
+  // aby existující vzorce (např. t^2) nezměnily význam.
+  if (expression.contains('^')) {
+    program->compile(QString(), variables); // Zneplatní předchozí přeložený výraz
+    return false;
+  }
+  return program->compile(expression, variables);
+}
+
 void ManualInputDialog::on_tableWidgetRollingSetup_cellChanged(int row, int column) {
   if (column == 0) {
     auto txt = ui->tableWidgetRollingSetup->item(row, column)->text();
-    bool ok = rollingChannelEvaluators.at(row)->setExpression(rollingEngine, txt);
-    QTableWidgetItem *item = new QTableWidgetItem(ok ? "OK" : txt.isEmpty() ? "Empty" : "Error");
+    bool compiled = compileGenerator(rollingChannelPrograms.at(row), txt, {"t"});
+    bool ok = compiled || rollingChannelEvaluators.at(row)->setExpression(rollingEngine, txt);
+    QTableWidgetItem *item = new QTableWidgetItem(compiled ? "OK" : ok ? "OK (JS)" : txt.isEmpty() ? "Empty" : "Error");
     item->setFlags(Qt::NoItemFlags | Qt::ItemIsEnabled);
     ui->tableWidgetRollingSetup->setItem(row, 1, item);
   }
@@ -140,8 +175,9 @@ void ManualInputDialog::on_tableWidgetRollingSetup_cellChanged(int row, int colu
 void ManualInputDialog::on_tableWidgetOscSetup_cellChanged(int row, int column) {
   if (column == 0) {
     auto txt = ui->tableWidgetOscSetup->item(row, column)->text();
-    bool ok = oscChannelEvaluators.at(row)->setExpression(oscEngine, txt);
-    QTableWidgetItem *item = new QTableWidgetItem(ok ? "OK" : txt.isEmpty() ? "Empty" : "Error");
+    bool compiled = compileGenerator(oscChannelPrograms.at(row), txt, {"t", "time"});
+    bool ok = compiled || oscChannelEvaluators.at(row)->setExpression(oscEngine, txt);
+    QTableWidgetItem *item = new QTableWidgetItem(compiled ? "OK" : ok ? "OK (JS)" : txt.isEmpty() ? "Empty" : "Error");
     item->setFlags(Qt::NoItemFlags | Qt::ItemIsEnabled);
     ui->tableWidgetOscSetup->setItem(row, 1, item);
   }
@@ -149,8 +185,11 @@ void ManualInputDialog::on_tableWidgetOscSetup_cellChanged(int row, int column)
 
 void ManualInputDialog::setExprRows(QTableWidget *table, int rows) {
   auto *evaluators = &rollingChannelEvaluators;
-  if (table == ui->tableWidgetOscSetup)
+  auto *programs = &rollingChannelPrograms;
+  if (table == ui->tableWidgetOscSetup) {
     evaluators = &oscChannelEvaluators;
+    programs = &oscChannelPrograms;
+  }
 
   while (table->rowCount() != rows) {
     int count = table->rowCount();
@@ -160,10 +199,13 @@ void ManualInputDialog::setExprRows(QTableWidget *table, int rows) {
       item->setFlags(Qt::NoItemFlags | Qt::ItemIsEnabled);
       table->setItem(count - 1, 1, item);
       evaluators->append(new VariableExpressionParser());
+      programs->append(new CompiledExpression());
     } else {
       table->removeRow(count - 2);
       delete evaluators->last();
       evaluators->removeLast();
+      delete programs->last();
+      programs->removeLast();
     }
   }
 
@@ -174,7 +216,11 @@ void ManualInputDialog::setExprRows(QTableWidget *table, int rows) {
   table->setVerticalHeaderLabels(names);
 }
 
-void ManualInputDialog::on_pushButtonRollingResetTime_clicked() { rollingTimestamp = 0; }
+void ManualInputDialog::on_pushButtonRollingResetTime_clicked() {
+  rollingTimestamp = 0;
+  for (auto &program : rollingChannelPrograms)
+    program->reset();
+}
 
 void ManualInputDialog::initTable(QTableWidget &table) {
   table.setRowCount(1);
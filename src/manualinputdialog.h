@@ -17,6 +17,7 @@
 #define MANUALINPUTDIALOG_H
 
 #include "global.h"
+#include "math/compiledexpression.h"
 #include "math/variableexpressionparser.h"
 #include "qicon.h"
 #include "qtablewidget.h"
@@ -65,12 +66,20 @@ private:
   QIcon iconPause;
   QList<VariableExpressionParser *> rollingChannelEvaluators;
   QList<VariableExpressionParser *> oscChannelEvaluators;
+  /// Přeložené výrazy, QJSEngine (evaluators) se použije jen pro výrazy, které nejdou přeložit (nebo obsahují ^, viz compileGenerator)
+  QList<CompiledExpression *> rollingChannelPrograms;
+  QList<CompiledExpression *> oscChannelPrograms;
+  QVector<double> oscTimes;
+  QVector<double> oscValues;
+  QVector<float> oscSamples;
   double rollingTimestamp = 0;
   double oscTimestamp = 0;
   QJSEngine rollingEngine;
   QJSEngine oscEngine;
 
   void setExprRows(QTableWidget *table, int rows);
+  /// Přeloží výraz generátoru, pokud by přeložený dával stejný výsledek jako JavaScript
+  static bool compileGenerator(CompiledExpression *program, const QString &expression, const QStringList &variables);
   void initRollingTable();
   void initOscTable();
 };
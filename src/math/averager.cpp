@@ -18,92 +18,158 @@
 Averager::Averager(QObject* parent) : QObject(parent) {
   for (int i = 0; i < ANALOG_COUNT; i++)
     averageCount[i] = 8;
-  listsChannels.resize(ANALOG_COUNT);
-  channelsResults.resize(ANALOG_COUNT);
-  points.resize(ANALOG_COUNT);
 }
 
-void Averager::reset() {
-  for (int i = 0; i < ANALOG_COUNT; i++) {
-    listsChannels[i].clear();
-    channelsResults[i].clear();
-    points[i].clear();
-    pointResults[i] = 0;
-  }
+void Averager::Ring::clear(int frameSize, int capacity, bool storeFrames) {
+  this->frameSize = frameSize;
+  this->capacity = capacity;
+  count = 0;
+  next = 0;
+  frames.fill(0, storeFrames ? capacity * frameSize : 0);
+  times.fill(0, capacity);
+  state.fill(0, frameSize);
 }
 
-void Averager::setCount(int chID, int count) {
-  this->averageCount[chID] = count;
-
-  while (listsChannels.at(chID).length() > count) {
-    for (int i = 0; i < channelsResults[chID].size(); i++) {
-      channelsResults[chID][i] -= listsChannels[chID].first().at(i);
-    }
-    listsChannels[chID].removeFirst();
+void Averager::Ring::setCapacity(int capacity) {
+  if (capacity == this->capacity)
+    return;
+  if (count == 0 || this->capacity == 0) {
+    clear(frameSize, capacity, !frames.isEmpty());
+    return;
   }
 
-  while (points.at(chID).length() > count) {
-    pointResults[chID] -= points.at(chID).first().second;
-    points[chID].removeFirst();
+  // Ponechá nejnovější průběhy, uloží je od začátku bufferu
+  int keep = qMin(count, capacity);
+  QVector<double> newFrames(frames.isEmpty() ? 0 : capacity * frameSize);
+  QVector<double> newTimes(capacity);
+  for (int i = 0; i < keep; i++) {
+    int from = (next - keep + i + this->capacity) % this->capacity;
+    if (!frames.isEmpty())
+      std::copy(slot(from), slot(from) + frameSize, newFrames.data() + (qint64)i * frameSize);
+    newTimes[i] = times.at(from);
   }
+  frames.swap(newFrames);
+  times.swap(newTimes);
+  this->capacity = capacity;
+  count = keep;
+  next = keep % capacity;
+  if (!frames.isEmpty())
+    recalculateSum();
 }
 
-void Averager::newDataVector(int chID, double timeStep, QSharedPointer<QCPGraphDataContainer> data) {
-  if (data->size() != channelsResults.at(chID).size() || timeStep != lastChannelSamplingPeriod[chID]) {
-    channelsResults[chID].clear();
-    listsChannels[chID].clear();
-  }
-
-  lastChannelSamplingPeriod[chID] = timeStep;
-
-  if (channelsResults.at(chID).isEmpty()) {
-    channelsResults[chID].resize(data->size());
+void Averager::Ring::recalculateSum() {
+  // Uložené průběhy jsou vždy na pozicích 0 až count - 1 (buffer se plní od začátku)
+  state.fill(0, frameSize);
+  double* sum = state.data();
+  for (int f = 0; f < count; f++) {
+    const double* frame = slot(f);
+    for (int i = 0; i < frameSize; i++)
+      sum[i] += frame[i];
   }
+}
 
-  listsChannels[chID].append(QVector<double>());
+double Averager::median(int count) {
+  auto middle = medianBuffer.begin() + count / 2;
+  std::nth_element(medianBuffer.begin(), middle, medianBuffer.begin() + count);
+  if (count % 2)
+    return *middle;
+  return (*middle + *std::max_element(medianBuffer.begin(), middle)) / 2.0;
+}
 
-  for (auto it = data->begin(); it != data->end(); it++) {
-    listsChannels[chID].last().append(it->value);
+void Averager::averageFrame(Ring& ring, double* values, int stride) {
+  int size = ring.frameSize;
+
+  if (mode == AverageMode::exponential) {
+    // Váha odpovídá klouzavému průměru ze stejného počtu průběhů, průběhy se neukládají
+    double* average = ring.state.data();
+    if (ring.count == 0) {
+      for (int i = 0; i < size; i++)
+        average[i] = values[i * stride];
+    } else {
+      double alpha = 2.0 / (ring.capacity + 1);
+      for (int i = 0; i < size; i++) {
+        average[i] += alpha * (values[i * stride] - average[i]);
+        values[i * stride] = average[i];
+      }
+    }
+    ring.count = qMin(ring.count + 1, ring.capacity);
+    ring.next = (ring.next + 1) % ring.capacity;
+    return;
   }
 
-  if (listsChannels[chID].size() == averageCount[chID] + 1) {
-    for (int i = 0; i < data->size(); i++) {
-      channelsResults[chID][i] -= listsChannels[chID].first().at(i);
+  bool full = (ring.count == ring.capacity);
+  double* frame = ring.slot(ring.next);
+  if (!full)
+    ring.count++;
+
+  if (mode == AverageMode::mean) {
+    // Jeden průchod: odečte nejstarší průběh (dokud není buffer plný, je na jeho místě 0), přičte nový,
+    // uloží ho na místo nejstaršího a zapíše průměr
+    double* sum = ring.state.data();
+    double scale = 1.0 / ring.count;
+    for (int i = 0; i < size; i++) {
+      double value = values[i * stride];
+      sum[i] += value - frame[i];
+      frame[i] = value;
+      values[i * stride] = sum[i] * scale;
     }
-    listsChannels[chID].removeFirst();
+    ring.next = (ring.next + 1) % ring.capacity;
+    if (full && ring.next == 0)
+      ring.recalculateSum();
+    return;
   }
 
-  Q_ASSERT(listsChannels[chID].size() <= averageCount[chID]);
-
-  for (int i = 0; i < data->size(); i++) {
-    channelsResults[chID][i] += data->at(i)->value;
+  for (int i = 0; i < size; i++)
+    frame[i] = values[i * stride];
+  ring.next = (ring.next + 1) % ring.capacity;
+  medianBuffer.resize(ring.count);
+  for (int i = 0; i < size; i++) {
+    const double* sample = ring.frames.constData() + i;
+    for (int f = 0; f < ring.count; f++)
+      medianBuffer[f] = sample[(qint64)f * size];
+    values[i * stride] = median(ring.count);
   }
+}
 
-  for (auto it = data->begin(); it != data->end(); it++) {
-    it->value = channelsResults[chID][it - data->begin()];
-    it->value /= listsChannels[chID].size();
+void Averager::reset() {
+  for (int i = 0; i < ANALOG_COUNT; i++) {
+    channels[i] = Ring();
+    points[i] = Ring();
   }
+}
 
-  emit addVectorToPlot(chID, data);
+void Averager::setCount(int chID, int count) {
+  this->averageCount[chID] = count;
+  channels[chID].setCapacity(count);
+  points[chID].setCapacity(count);
 }
 
-void Averager::newDataPoint(int chID, double time, double value, bool append) {
-  if (!append) {
-    points[chID].clear();
-    pointResults[chID] = 0;
-  }
+void Averager::setMode(AverageMode::enumAverageMode mode) {
+  this->mode = mode;
+  reset();
+}
 
-  points[chID].append(QPair<double, double>(time, value));
+void Averager::newDataVector(int chID, double timeStep, QSharedPointer<QCPGraphDataContainer> data) {
+  Ring& ring = channels[chID];
+  if (data->size() != ring.frameSize || timeStep != ring.samplingPeriod || ring.capacity != averageCount[chID])
+    ring.clear(data->size(), averageCount[chID], storeFrames());
+  ring.samplingPeriod = timeStep;
 
-  if (points[chID].size() == averageCount[chID] + 1) {
-    pointResults[chID] -= points[chID].first().second;
-    points[chID].removeFirst();
-  }
+  // Hodnoty se průměrují přímo v datech (QCPGraphData je dvojice key, value)
+  if (!data->isEmpty())
+    averageFrame(ring, &data->begin()->value, sizeof(QCPGraphData) / sizeof(double));
 
-  Q_ASSERT(listsChannels[chID].size() <= averageCount[chID]);
+  emit addVectorToPlot(chID, data);
+}
+
+void Averager::newDataPoint(int chID, double time, double value, bool append) {
+  Ring& ring = points[chID];
+  if (!append || ring.frameSize == 0 || ring.capacity != averageCount[chID])
+    ring.clear(1, averageCount[chID], storeFrames());
 
-  pointResults[chID] += value;
+  ring.times[ring.next] = time;
+  averageFrame(ring, &value, 1);
 
-  double midTime = (points.at(chID).first().first + points.at(chID).last().first) / 2.0;
-  emit addPointToPlot(chID, midTime, pointResults[chID] / points.at(chID).size(), append);
+  double midTime = (ring.times.at(ring.oldest()) + ring.times.at(ring.newest())) / 2.0;
+  emit addPointToPlot(chID, midTime, value, append);
 }
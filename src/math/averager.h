@@ -26,16 +26,45 @@ class Averager : public QObject {
   explicit Averager(QObject* parent = nullptr);
 
  private:
-  QVector<QList<QVector<double>>> listsChannels;
-  QVector<QVector<double>> channelsResults;
+  /// Kruhový buffer posledních průběhů (nebo bodů) jednoho kanálu, alokuje se jen při změně délky nebo počtu
+  struct Ring {
+    int frameSize = 0;
+    int capacity = 0;
+    /// Počet uložených průběhů
+    int count = 0;
+    /// Pozice, na kterou se zapíše další průběh
+    int next = 0;
+    /// Průběhy za sebou v jednom poli (capacity * frameSize)
+    QVector<double> frames;
+    /// Časy bodů (jen v režimu bodů)
+    QVector<double> times;
+    /// Průběžný součet (mean) nebo průměr (exponential) pro každý vzorek
+    QVector<double> state;
+    double samplingPeriod = 0;
+
+    void clear(int frameSize, int capacity, bool storeFrames);
+    void setCapacity(int capacity);
+    /// Přepočítá součet z uložených průběhů (odstraní nasčítanou zaokrouhlovací chybu)
+    void recalculateSum();
+    double* slot(int index) { return frames.data() + (qint64)index * frameSize; }
+    int oldest() const { return (next - count + capacity) % capacity; }
+    int newest() const { return (next - 1 + capacity) % capacity; }
+  };
+
+  AverageMode::enumAverageMode mode = AverageMode::mean;
+  Ring channels[ANALOG_COUNT];
+  Ring points[ANALOG_COUNT];
   int averageCount[ANALOG_COUNT];
-  double lastChannelSamplingPeriod[ANALOG_COUNT];
-  QVector<QList<QPair<double, double>>> points;
-  double pointResults[ANALOG_COUNT];
+  QVector<double> medianBuffer;
+  double median(int count);
+  bool storeFrames() const { return mode != AverageMode::exponential; }
+  /// Zprůměruje průběh uložený ve values (krok stride) s předchozími, výsledek zapíše zpět do values
+  void averageFrame(Ring& ring, double* values, int stride);
 
  public slots:
   void reset();
   void setCount(int chID, int count);
+  void setMode(AverageMode::enumAverageMode mode);
   void newDataVector(int chID, double timeStep, QSharedPointer<QCPGraphDataContainer> data);
   void newDataPoint(int chID, double time, double value, bool append);
 
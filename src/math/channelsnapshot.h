@@ -0,0 +1,198 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHANNELSNAPSHOT_H
+#define CHANNELSNAPSHOT_H
+
+#include <algorithm>
+
+#include "plots/qcustomplot.h"
+
+/// Úsek dat kanálu předávaný výpočtům v jiném vlákně (měření, FFT, XY, export), vzniká jen z ChannelHistory.
+/// Vzorky snímku se už nikdy nemění, omezení rozsahu jen posouvá ukazatele.
+/// Vytvoření snímku nic nekopíruje, snímek jen drží paměť historie (nebo převzatý rámec), dokud existuje.
+class ChannelSnapshot {
+public:
+  ChannelSnapshot() {}
+
+  int channel() const { return chID; }
+  /// Generace dat kanálu (0 = neznámá). Dva snímky stejné generace se liší jen vzorky odebranými
+  /// ze začátku a přidanými na konec, jakákoli jiná změna dat kanálu generaci změní.
+  quint64 generation() const { return gen; }
+  /// Pořadí prvního vzorku snímku od začátku generace (počítá i vzorky, které už z kanálu vypadly)
+  qint64 startIndex() const { return start; }
+
+  int size() const { return last - first; }
+  bool isEmpty() const { return first >= last; }
+  const QCPGraphData &at(int index) const { return first[index]; }
+  const QCPGraphData *constBegin() const { return first; }
+  const QCPGraphData *constEnd() const { return last; }
+
+  /// Index prvního vzorku s časem alespoň key (size(), pokud takový není)
+  int findBegin(double key) const { return std::lower_bound(constBegin(), constEnd(), QCPGraphData::fromSortKey(key), qcpLessThanSortKey<QCPGraphData>) - constBegin(); }
+
+  /// Vynechá vzorky s časem před from (jako removeBefore)
+  void limitBefore(double from) {
+    int removed = findBegin(from);
+    first += removed;
+    start += removed;
+  }
+  /// Vynechá vzorky s časem po to (jako removeAfter)
+  void limitAfter(double to) { last = std::upper_bound(constBegin(), constEnd(), QCPGraphData::fromSortKey(to), qcpLessThanSortKey<QCPGraphData>); }
+  void limitRange(const QCPRange &range) {
+    limitBefore(range.lower);
+    limitAfter(range.upper);
+  }
+
+  QCPRange valueRange() const {
+    QCPRange range;
+    bool found = false;
+    for (auto it = constBegin(); it != constEnd(); it++) {
+      if (qIsNaN(it->value))
+        continue;
+      if (!found)
+        range = QCPRange(it->value, it->value);
+      else
+        range.expand(it->value);
+      found = true;
+    }
+    return range;
+  }
+
+  static QSharedPointer<QCPGraphData> allocate(int capacity) { return QSharedPointer<QCPGraphData>(new QCPGraphData[std::max(capacity, 1)], [](QCPGraphData *samples) { delete[] samples; }); }
+
+private:
+  friend class ChannelHistory;
+  /// Drží paměť vzorků, dokud existuje nějaký snímek (buď kopii historie, nebo převzatý kontejner rámce)
+  QSharedPointer<QCPGraphData> samples;
+  QSharedPointer<QCPGraphDataContainer> frame;
+  const QCPGraphData *first = nullptr, *last = nullptr;
+  int chID = -1;
+  quint64 gen = 0;
+  qint64 start = 0;
+};
+
+/// Data kanálu hlavního grafu, ze kterých se dělají snímky pro jiná vlákna.
+/// Kanál přijímaný po rámcích historie jen převezme (adopt): kontejner rámce sdílí s grafem a nic se nekopíruje,
+/// graf ho pak nesmí měnit na místě (musí ho nahradit, viz isAdopted).
+/// Kanál přijímaný po bodech graf mění na místě, historie proto drží vlastní kopii jeho vzorků (paměť kanálu je dvojnásobná).
+/// Kopie vznikne při prvním snímku (reset) a dál se jen doplňuje: vzorky se přidávají na konec za poslední zapsaný vzorek
+/// (snímky za svůj konec nikdy nečtou) a ze začátku se odebírají jen posunem začátku. Když dojde místo, zbylé vzorky se přesunou
+/// do nové paměti (dvojnásobné velikosti, takže přidání vzorku je amortizovaně O(1)), stará paměť zůstane snímkům, které ji drží.
+class ChannelHistory {
+public:
+  bool isValid() const { return gen != 0; }
+  /// Zahodí obsah, další snímek si historii vytvoří znovu z grafu (nová generace)
+  void invalidate() {
+    gen = 0;
+    frame.reset();
+    samples.reset();
+    capacity = first = last = 0;
+    origin = 0;
+  }
+  /// Převezme rámec (nová generace), který už se nebude měnit na místě
+  void adopt(const QSharedPointer<QCPGraphDataContainer> &data) {
+    invalidate();
+    frame = data;
+    gen = nextGeneration();
+  }
+  bool isAdopted(const QSharedPointer<QCPGraphDataContainer> &data) const { return frame && frame == data; }
+  /// Vyprázdní kopii vzorků (nová generace), převzatou nebo neplatnou historii jen zneplatní
+  void clear() {
+    bool keep = isValid() && !frame;
+    invalidate();
+    if (keep)
+      gen = nextGeneration();
+  }
+  /// Nahradí obsah kopií dat grafu (nová generace)
+  void reset(const QCPGraphDataContainer &data) {
+    invalidate();
+    gen = nextGeneration();
+    reserve(data.size());
+    std::copy(data.constBegin(), data.constEnd(), samples.data());
+    last = data.size();
+  }
+  /// Přidá vzorky na konec. Vrací false, pokud by nenavazovaly (graf je zatřídil dovnitř), historie je pak neplatná.
+  bool append(const QCPGraphData *added, int count) {
+    if (!isValid() || frame)
+      return false;
+    if (count <= 0)
+      return true;
+    if (last > first && qcpLessThanSortKey(added[0], samples.data()[last - 1])) {
+      invalidate();
+      return false;
+    }
+    reserve(last - first + count);
+    std::copy(added, added + count, samples.data() + last);
+    last += count;
+    return true;
+  }
+  /// Odebere count nejstarších vzorků (generace zůstává, snímky to poznají podle startIndex)
+  void removeFront(int count) {
+    count = std::min(count, last - first);
+    first += count;
+  }
+
+  ChannelSnapshot snapshot(int channel) const {
+    ChannelSnapshot snapshot;
+    snapshot.chID = channel;
+    snapshot.gen = gen;
+    if (frame) {
+      snapshot.frame = frame;
+      if (!frame->isEmpty()) {
+        snapshot.first = &*frame->constBegin();
+        snapshot.last = snapshot.first + frame->size();
+      }
+      return snapshot;
+    }
+    snapshot.samples = samples;
+    snapshot.first = samples.data() + first;
+    snapshot.last = samples.data() + last;
+    snapshot.start = origin + first;
+    return snapshot;
+  }
+
+private:
+  QSharedPointer<QCPGraphDataContainer> frame;
+  QSharedPointer<QCPGraphData> samples;
+  int capacity = 0;
+  int first = 0, last = 0;
+  /// Pořadí vzorku samples[0] od začátku generace
+  qint64 origin = 0;
+  quint64 gen = 0;
+
+  /// Zajistí místo pro size vzorků od first, případně přesune vzorky do nové paměti
+  void reserve(int size) {
+    if (samples && first + size <= capacity)
+      return;
+    int newCapacity = std::max(2 * size, 1024);
+    QSharedPointer<QCPGraphData> newSamples = ChannelSnapshot::allocate(newCapacity);
+    if (samples)
+      std::copy(samples.data() + first, samples.data() + last, newSamples.data());
+    origin += first;
+    last -= first;
+    first = 0;
+    samples = newSamples;
+    capacity = newCapacity;
+  }
+
+  static quint64 nextGeneration() {
+    // Jen z vlákna GUI
+    static quint64 counter = 0;
+    return ++counter;
+  }
+};
+
+#endif // CHANNELSNAPSHOT_H
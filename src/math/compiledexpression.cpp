@@ -0,0 +1,546 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "compiledexpression.h"
+#include <QRandomGenerator>
+#include <algorithm>
+#include <math.h>
+
+struct Function1 {
+  const char *name;
+  double (*function)(double);
+};
+
+struct Function2 {
+  const char *name;
+  double (*function)(double, double);
+};
+
+// Funkce se stejnými názvy a chováním jako Math v JS
+static const Function1 functions1[] = {
+    {"abs", [](double x) { return fabs(x); }},   {"acos", [](double x) { return acos(x); }},  {"asin", [](double x) { return asin(x); }},   {"atan", [](double x) { return atan(x); }},
+    {"cbrt", [](double x) { return cbrt(x); }},  {"ceil", [](double x) { return ceil(x); }},  {"cos", [](double x) { return cos(x); }},     {"cosh", [](double x) { return cosh(x); }},
+    {"exp", [](double x) { return exp(x); }},    {"floor", [](double x) { return floor(x); }}, {"log", [](double x) { return log(x); }},    {"log10", [](double x) { return log10(x); }},
+    {"log2", [](double x) { return log2(x); }},  {"round", [](double x) { return floor(x + 0.5); }},
+    {"sign", [](double x) { return x > 0 ? 1.0 : (x < 0 ? -1.0 : x); }},
+    {"sin", [](double x) { return sin(x); }},    {"sinh", [](double x) { return sinh(x); }},  {"sqrt", [](double x) { return sqrt(x); }},   {"tan", [](double x) { return tan(x); }},
+    {"tanh", [](double x) { return tanh(x); }},  {"trunc", [](double x) { return trunc(x); }},
+};
+
+static const Function2 functions2[] = {
+    {"atan2", [](double y, double x) { return atan2(y, x); }},
+    {"pow", [](double x, double y) { return pow(x, y); }},
+    {"min", [](double a, double b) { return (qIsNaN(a) || qIsNaN(b)) ? Q_QNAN : MIN(a, b); }},
+    {"max", [](double a, double b) { return (qIsNaN(a) || qIsNaN(b)) ? Q_QNAN : MAX(a, b); }},
+};
+
+template <typename Operation> void CompiledExpression::binaryLoop(double *dst, const double *left, const double *right, ConstOperand constOperand, double constant, int count, Operation operation) {
+  if (constOperand == constLeft) {
+    for (int i = 0; i < count; i++)
+      dst[i] = operation(constant, right[i]);
+  } else if (constOperand == constRight) {
+    for (int i = 0; i < count; i++)
+      dst[i] = operation(left[i], constant);
+  } else {
+    for (int i = 0; i < count; i++)
+      dst[i] = operation(left[i], right[i]);
+  }
+}
+
+CompiledExpression::CompiledExpression(QObject *parent) : ExpressionParser{parent} {}
+
+bool CompiledExpression::compile(const QString &expression, const QStringList &variables) {
+  text = expression;
+  int comment = text.indexOf("//"); // Komentář do konce (jako v JS)
+  if (comment >= 0)
+    text.truncate(comment);
+  text.replace(QString::fromUtf8("\xc2\xb5"), "u"); // mu
+  pos = 0;
+  variableNames = variables;
+  nodes.clear();
+  error.clear();
+  program.clear();
+  averages.clear();
+  used.clear();
+  registerCount = 0;
+  valid = false;
+
+  int root = parseSum();
+  skipSpaces();
+  if (root >= 0 && pos < text.length()) {
+    error = tr("Unexpected \"%1\"").arg(text.mid(pos, 10));
+    root = -1;
+  }
+  if (root < 0) {
+    if (error.isEmpty())
+      error = tr("Invalid expression");
+    return false;
+  }
+
+  root = fold(root);
+  generate(root, 0);
+  for (const Instruction &instruction : qAsConst(program))
+    if (instruction.op == opVariable && !used.contains(instruction.variable))
+      used.append(instruction.variable);
+  std::sort(used.begin(), used.end());
+  registers.resize(registerCount * EXPRESSION_BLOCK_SIZE);
+  valid = true;
+  return true;
+}
+
+void CompiledExpression::reset() {
+  for (AverageState &average : averages) {
+    average.position = 0;
+    average.filled = 0;
+    average.sum = 0;
+  }
+}
+
+void CompiledExpression::evaluate(const QVector<Variable> &variables, int count, double *result) {
+  if (!valid) {
+    std::fill(result, result + count, Q_QNAN);
+    return;
+  }
+  // Po blocích, registry jednoho bloku se vejdou do cache
+  for (int begin = 0; begin < count; begin += EXPRESSION_BLOCK_SIZE) {
+    int blockCount = MIN(EXPRESSION_BLOCK_SIZE, count - begin);
+    for (const Instruction &instruction : qAsConst(program))
+      execute(instruction, variables, begin, blockCount);
+    std::copy(registers.constBegin(), registers.constBegin() + blockCount, result + begin); // Výsledek je v registru 0
+  }
+}
+
+double CompiledExpression::evaluate(const QVector<double> &variables) {
+  QVector<Variable> sources(variables.size());
+  for (int i = 0; i < variables.size(); i++)
+    sources[i].values = &variables.at(i);
+  double result;
+  evaluate(sources, 1, &result);
+  return result;
+}
+
+void CompiledExpression::execute(const Instruction &instruction, const QVector<Variable> &variables, int begin, int count) {
+  double *dst = registers.data() + instruction.dst * EXPRESSION_BLOCK_SIZE;
+  const double *left = registers.constData() + instruction.left * EXPRESSION_BLOCK_SIZE;
+  const double *right = registers.constData() + instruction.right * EXPRESSION_BLOCK_SIZE;
+  ConstOperand constOperand = instruction.constOperand;
+  double constant = instruction.constant;
+
+  switch (instruction.op) {
+    case opConst:
+      std::fill(dst, dst + count, constant);
+      break;
+    case opVariable: {
+      const Variable &variable = variables.at(instruction.variable);
+      if (variable.values == nullptr) {
+        std::fill(dst, dst + count, Q_QNAN);
+        break;
+      }
+      const double *values = variable.values + (qint64)begin * variable.stride;
+      for (int i = 0; i < count; i++)
+        dst[i] = values[i * variable.stride];
+      break;
+    }
+    case opAdd:
+      binaryLoop(dst, left, right, constOperand, constant, count, [](double a, double b) { return a + b; });
+      break;
+    case opSubtract:
+      binaryLoop(dst, left, right, constOperand, constant, count, [](double a, double b) { return a - b; });
+      break;
+    case opMultiply:
+      binaryLoop(dst, left, right, constOperand, constant, count, [](double a, double b) { return a * b; });
+      break;
+    case opDivide:
+      binaryLoop(dst, left, right, constOperand, constant, count, [](double a, double b) { return a / b; });
+      break;
+    case opModulo:
+      binaryLoop(dst, left, right, constOperand, constant, count, [](double a, double b) { return fmod(a, b); });
+      break;
+    case opPower:
+      if (constOperand == constRight && constant == 2) {
+        for (int i = 0; i < count; i++)
+          dst[i] = left[i] * left[i];
+      } else
+        binaryLoop(dst, left, right, constOperand, constant, count, [](double a, double b) { return pow(a, b); });
+      break;
+    case opNegate:
+      for (int i = 0; i < count; i++)
+        dst[i] = -left[i];
+      break;
+    case opFunction1:
+      for (int i = 0; i < count; i++)
+        dst[i] = instruction.function1(left[i]);
+      break;
+    case opFunction2:
+      binaryLoop(dst, left, right, constOperand, constant, count, instruction.function2);
+      break;
+    case opRandom:
+      for (int i = 0; i < count; i++)
+        dst[i] = QRandomGenerator::global()->generateDouble();
+      break;
+    case opAverage: {
+      // Klouzavý průměr, historie pokračuje i přes hranice bloků a volání evaluate (do reset)
+      AverageState &average = averages[instruction.average];
+      double *history = average.history.data();
+      for (int i = 0; i < count; i++) {
+        if (average.filled == average.length)
+          average.sum -= history[average.position];
+        else
+          average.filled++;
+        history[average.position] = left[i];
+        average.sum += left[i];
+        if (++average.position == average.length)
+          average.position = 0;
+        dst[i] = average.sum / average.filled;
+      }
+      break;
+    }
+  }
+}
+
+int CompiledExpression::addNode(const Node &node) {
+  nodes.append(node);
+  return nodes.size() - 1;
+}
+
+void CompiledExpression::skipSpaces() {
+  while (pos < text.length() && text.at(pos).isSpace())
+    pos++;
+}
+
+bool CompiledExpression::accept(const QString &token) {
+  skipSpaces();
+  if (text.mid(pos, token.length()) != token)
+    return false;
+  pos += token.length();
+  return true;
+}
+
+int CompiledExpression::parseSum() {
+  int left = parseProduct();
+  while (left >= 0) {
+    Node node;
+    if (accept("+"))
+      node.op = opAdd;
+    else if (accept("-"))
+      node.op = opSubtract;
+    else
+      break;
+    node.left = left;
+    node.right = parseProduct();
+    if (node.right < 0)
+      return -1;
+    left = addNode(node);
+  }
+  return left;
+}
+
+int CompiledExpression::parseProduct() {
+  int left = parseUnary();
+  while (left >= 0) {
+    Node node;
+    if (accept("*"))
+      node.op = opMultiply;
+    else if (accept("/"))
+      node.op = opDivide;
+    else if (accept("%"))
+      node.op = opModulo;
+    else
+      break;
+    node.left = left;
+    node.right = parseUnary();
+    if (node.right < 0)
+      return -1;
+    left = addNode(node);
+  }
+  return left;
+}
+
+int CompiledExpression::parseUnary() {
+  if (accept("-")) {
+    Node node;
+    node.op = opNegate;
+    node.left = parseUnary();
+    return node.left < 0 ? -1 : addNode(node);
+  }
+  if (accept("+"))
+    return parseUnary();
+  return parsePower();
+}
+
+int CompiledExpression::parsePower() {
+  int base = parsePrimary();
+  if (base < 0)
+    return -1;
+  if (accept("^") || accept("**")) {
+    Node node;
+    node.op = opPower;
+    node.left = base;
+    node.right = parseUnary(); // Zprava asociativní, 2^-1 je povoleno
+    return node.right < 0 ? -1 : addNode(node);
+  }
+  return base;
+}
+
+int CompiledExpression::parsePrimary() {
+  skipSpaces();
+  if (pos >= text.length()) {
+    error = tr("Unexpected end of expression");
+    return -1;
+  }
+  QChar c = text.at(pos);
+  if (c == '(') {
+    pos++;
+    int inner = parseSum();
+    if (inner >= 0 && !accept(")")) {
+      error = tr("Missing \")\"");
+      return -1;
+    }
+    return inner;
+  }
+  if (c.isDigit() || c == '.')
+    return parseNumber();
+  if (c.isLetter() || c == '_')
+    return parseIdentifier();
+  error = tr("Unexpected \"%1\"").arg(c);
+  return -1;
+}
+
+int CompiledExpression::parseNumber() {
+  int start = pos;
+  while (pos < text.length() && (text.at(pos).isDigit() || text.at(pos) == '.'))
+    pos++;
+  // Exponent, jen pokud následuje číslice (jinak je "E" předpona exa)
+  if (pos < text.length() && (text.at(pos) == 'e' || text.at(pos) == 'E')) {
+    int exponent = pos + 1;
+    if (exponent < text.length() && (text.at(exponent) == '+' || text.at(exponent) == '-'))
+      exponent++;
+    if (exponent < text.length() && text.at(exponent).isDigit()) {
+      pos = exponent;
+      while (pos < text.length() && text.at(pos).isDigit())
+        pos++;
+    }
+  }
+
+  bool ok;
+  Node node;
+  node.op = opConst;
+  node.value = text.mid(start, pos - start).toDouble(&ok);
+  if (!ok) {
+    error = tr("Invalid number \"%1\"").arg(text.mid(start, pos - start));
+    return -1;
+  }
+
+  // Předpona SI přímo za číslem (5m, 2k), ne začátek názvu (2max)
+  if (pos < text.length() && prefixes.contains(text.at(pos))) {
+    bool partOfName = pos + 1 < text.length() && (text.at(pos + 1).isLetterOrNumber() || text.at(pos + 1) == '_');
+    if (!partOfName) {
+      node.value *= prefixes.value(text.at(pos)).toDouble();
+      pos++;
+    }
+  }
+  return addNode(node);
+}
+
+int CompiledExpression::parseIdentifier() {
+  auto readName = [this]() {
+    int start = pos;
+    while (pos < text.length() && (text.at(pos).isLetterOrNumber() || text.at(pos) == '_'))
+      pos++;
+    return text.mid(start, pos - start);
+  };
+  QString name = readName();
+  if (name == "Math" && accept(".")) // Zápis jako v JS (Math.sin)
+    name = readName();
+
+  if (!accept("(")) {
+    Node node;
+    if (name == "PI" || name == "Pi" || name == "pi") {
+      node.op = opConst;
+      node.value = M_PI;
+      return addNode(node);
+    }
+    node.op = opVariable;
+    node.variable = variableNames.indexOf(name);
+    if (node.variable < 0) {
+      error = tr("Unknown name \"%1\"").arg(name);
+      return -1;
+    }
+    return addNode(node);
+  }
+
+  // Argumenty funkce
+  QList<int> arguments;
+  if (!accept(")")) {
+    do {
+      int argument = parseSum();
+      if (argument < 0)
+        return -1;
+      arguments.append(argument);
+    } while (accept(","));
+    if (!accept(")")) {
+      error = tr("Missing \")\"");
+      return -1;
+    }
+  }
+
+  Node node;
+  if (name == "random" && arguments.isEmpty()) {
+    node.op = opRandom;
+    return addNode(node);
+  }
+
+  if (name == "avg" && arguments.size() == 2) {
+    int length = fold(arguments.at(1));
+    if (!isConst(length) || nodes.at(length).value < 1) {
+      error = tr("Length of avg must be a positive constant");
+      return -1;
+    }
+    node.op = opAverage;
+    node.left = arguments.at(0);
+    node.value = floor(nodes.at(length).value);
+    return addNode(node);
+  }
+
+  for (const Function1 &function : functions1) {
+    if (name == function.name && arguments.size() == 1) {
+      node.op = opFunction1;
+      node.left = arguments.at(0);
+      node.function1 = function.function;
+      return addNode(node);
+    }
+  }
+
+  for (const Function2 &function : functions2) {
+    bool variadic = (name == "min" || name == "max");
+    if (name == function.name && (arguments.size() == 2 || (variadic && arguments.size() > 2))) {
+      // min(a, b, c) = min(min(a, b), c)
+      int left = arguments.at(0);
+      for (int i = 1; i < arguments.size(); i++) {
+        node.op = opFunction2;
+        node.left = left;
+        node.right = arguments.at(i);
+        node.function2 = function.function;
+        left = addNode(node);
+      }
+      return left;
+    }
+  }
+
+  error = tr("Unknown function \"%1\" with %2 arguments").arg(name).arg(arguments.size());
+  return -1;
+}
+
+int CompiledExpression::fold(int index) {
+  Node &node = nodes[index];
+  if (node.left >= 0)
+    node.left = fold(node.left);
+  if (node.right >= 0)
+    node.right = fold(node.right);
+
+  if (node.op == opConst || node.op == opVariable || node.op == opRandom)
+    return index;
+  if (node.op == opAverage) {
+    // Průměr konstanty je ta konstanta
+    return isConst(node.left) ? node.left : index;
+  }
+  bool unary = (node.op == opNegate || node.op == opFunction1);
+  if (!isConst(node.left) || (!unary && !isConst(node.right)))
+    return index;
+
+  node.value = calculate(node.op, nodes.at(node.left).value, unary ? 0 : nodes.at(node.right).value, node.function1, node.function2);
+  node.op = opConst;
+  node.left = node.right = -1;
+  return index;
+}
+
+void CompiledExpression::generate(int index, int reg) {
+  const Node &node = nodes.at(index);
+  registerCount = MAX(registerCount, reg + 1);
+
+  Instruction instruction;
+  instruction.op = node.op;
+  instruction.dst = reg;
+  instruction.function1 = node.function1;
+  instruction.function2 = node.function2;
+
+  switch (node.op) {
+    case opConst:
+      instruction.constant = node.value;
+      break;
+    case opVariable:
+      instruction.variable = node.variable;
+      break;
+    case opRandom:
+      break;
+    case opAverage: {
+      AverageState average;
+      average.length = node.value;
+      average.history.resize(average.length);
+      instruction.average = averages.size();
+      averages.append(average);
+    }
+      // fall through
+    case opNegate:
+    case opFunction1:
+      generate(node.left, reg);
+      instruction.left = reg;
+      break;
+    default:
+      // Konstantní operand se nepočítá do registru
+      if (isConst(node.left)) {
+        generate(node.right, reg);
+        instruction.right = reg;
+        instruction.constOperand = constLeft;
+        instruction.constant = nodes.at(node.left).value;
+      } else if (isConst(node.right)) {
+        generate(node.left, reg);
+        instruction.left = reg;
+        instruction.constOperand = constRight;
+        instruction.constant = nodes.at(node.right).value;
+      } else {
+        generate(node.left, reg);
+        generate(node.right, reg + 1);
+        instruction.left = reg;
+        instruction.right = reg + 1;
+      }
+  }
+  program.append(instruction);
+}
+
+double CompiledExpression::calculate(Opcode op, double a, double b, double (*function1)(double), double (*function2)(double, double)) {
+  switch (op) {
+    case opAdd:
+      return a + b;
+    case opSubtract:
+      return a - b;
+    case opMultiply:
+      return a * b;
+    case opDivide:
+      return a / b;
+    case opModulo:
+      return fmod(a, b);
+    case opPower:
+      return pow(a, b);
+    case opNegate:
+      return -a;
+    case opFunction1:
+      return function1(a);
+    case opFunction2:
+      return function2(a, b);
+    default:
+      return Q_QNAN;
+  }
+}
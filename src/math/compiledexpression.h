@@ -0,0 +1,122 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COMPILEDEXPRESSION_H
+#define COMPILEDEXPRESSION_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "global.h"
+#include "math/expressionparser.h"
+
+/// Výraz přeložený do programu nad registry (bez QJSEngine).
+/// Každá instrukce zpracuje celý blok vzorků najednou, takže se vyhodnocení vektoru skládá z jednoduchých smyček.
+/// Podporuje + - * / % ^ (i **), závorky, čísla s předponami SI (5m, 2k, 3µ), konstantu PI,
+/// funkce jako Math v JS (sin, sqrt, pow, min, max, random...) a klouzavý průměr avg(x, N).
+class CompiledExpression : public ExpressionParser {
+  Q_OBJECT
+
+public:
+  /// Zdroj hodnot proměnné: hodnota vzorku i je values[i * stride]
+  struct Variable {
+    const double *values = nullptr;
+    int stride = 1;
+  };
+
+  explicit CompiledExpression(QObject *parent = nullptr);
+
+  /// Přeloží výraz, variables jsou názvy proměnných, které se v něm mohou vyskytovat.
+  bool compile(const QString &expression, const QStringList &variables);
+  bool isValid() const { return valid; }
+  /// Popis chyby po neúspěšném compile
+  QString errorString() const { return error; }
+  /// Indexy (do seznamu z compile) proměnných, které výraz používá
+  QList<int> usedVariables() const { return used; }
+
+  /// Vyhodnotí výraz pro count vzorků. Proměnné se indexují stejně jako seznam z compile, nepoužité mohou být prázdné.
+  void evaluate(const QVector<Variable> &variables, int count, double *result);
+  /// Vyhodnotí výraz pro jeden vzorek
+  double evaluate(const QVector<double> &variables);
+  /// Vymaže historii klouzavých průměrů (začátek nového průběhu)
+  void reset();
+
+private:
+  enum Opcode { opConst, opVariable, opAdd, opSubtract, opMultiply, opDivide, opModulo, opPower, opNegate, opFunction1, opFunction2, opRandom, opAverage };
+  /// Operand instrukce může být registr nebo konstanta
+  enum ConstOperand { constNone, constLeft, constRight };
+
+  struct Node {
+    Opcode op;
+    int left = -1, right = -1;
+    double value = 0;
+    int variable = -1;
+    double (*function1)(double) = nullptr;
+    double (*function2)(double, double) = nullptr;
+  };
+
+  struct Instruction {
+    Opcode op;
+    int dst = 0, left = 0, right = 0;
+    ConstOperand constOperand = constNone;
+    double constant = 0;
+    int variable = -1;
+    double (*function1)(double) = nullptr;
+    double (*function2)(double, double) = nullptr;
+    int average = -1;
+  };
+
+  struct AverageState {
+    int length;
+    QVector<double> history;
+    int position = 0, filled = 0;
+    double sum = 0;
+  };
+
+  // Překlad
+  QString text;
+  int pos = 0;
+  QStringList variableNames;
+  QVector<Node> nodes;
+  QString error;
+  int addNode(const Node &node);
+  int parseSum();
+  int parseProduct();
+  int parseUnary();
+  int parsePower();
+  int parsePrimary();
+  int parseNumber();
+  int parseIdentifier();
+  void skipSpaces();
+  bool accept(const QString &token);
+  bool isConst(int node) const { return node >= 0 && nodes.at(node).op == opConst; }
+  int fold(int node);
+  void generate(int node, int reg);
+
+  // Program
+  bool valid = false;
+  QVector<Instruction> program;
+  QVector<AverageState> averages;
+  QList<int> used;
+  int registerCount = 0;
+  QVector<double> registers;
+  void execute(const Instruction &instruction, const QVector<Variable> &variables, int begin, int count);
+  template <typename Operation> static void binaryLoop(double *dst, const double *left, const double *right, ConstOperand constOperand, double constant, int count, Operation operation);
+  /// Jedna operace s konstantními operandy (zjednodušení výrazu při překladu)
+  static double calculate(Opcode op, double a, double b, double (*function1)(double), double (*function2)(double, double));
+};
+
+#endif // COMPILEDEXPRESSION_H
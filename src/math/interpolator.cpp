@@ -16,7 +16,7 @@
 #include "interpolator.h"
 
 Interpolator::Interpolator(QObject* parent) : QObject(parent) {
-
+  cache.resize(ANALOG_COUNT + MATH_COUNT);
 }
 
 void Interpolator::interpolate(int chID, const QSharedPointer<QCPGraphDataContainer> data, QCPRange visibleRange, bool dataIsFromInterpolationBuffer) {
@@ -25,8 +25,6 @@ void Interpolator::interpolate(int chID, const QSharedPointer<QCPGraphDataContai
   double fs = (data->size() - 1) / (data->at(data->size() - 1)->key - data->at(0)->key);
   double resultSamplingPeriod = 1.0 / upsampling / fs;
 
-  QVector<float> values;
-
   auto dataBegin = data->constBegin(); // Při volání této funkce se změní adresy v data!!!
   auto dataEnd = data->constEnd();
 
@@ -41,31 +39,56 @@ void Interpolator::interpolate(int chID, const QSharedPointer<QCPGraphDataContai
   if (end > dataEnd)
     end = dataEnd;
 
-  for (auto it = begin; it != end; it++) {
-    values.append(it->value);
-    for (int i = 1; i < upsampling; i++)
-      values.append(0);
-  }
+  int length = end - begin;
 
-  if (values.length() < lowPassFIR.size()) {
+  if (length * upsampling < lowPassFIR.size() || polyphaseFIR.isEmpty()) {
     // Moc málo vzorků, nemá to cenu
     auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer(*data));
     emit interpolationResult(chID, data, result, dataIsFromInterpolationBuffer);
     return;
   }
 
-  if (values.length() > 2000 * upsampling) {
-    // Hodně vzorků, nemá cenu interpolovat
-    auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer(*data));
-    emit interpolationResult(chID, data, result, dataIsFromInterpolationBuffer);
-    return;
+  QVector<double> keys(length);
+  samples.resize(length);
+  for (int i = 0; i < length; i++) {
+    keys[i] = begin[i].key;
+    samples[i] = begin[i].value;
   }
 
-  values = filter(values, lowPassFIR);
+  // Výstup odpovídá konvoluci signálu s vloženými nulami, prvních a posledních M/2 vzorků je vynecháno (přechodné jevy).
+  // Výstup se tedy předbíhá o M/2 oproti vstupu (filtrovaný signál by se o M/2 zpožďoval, ale na začátku je vynecháno M vzorků)
+  int count = length * upsampling - M;
+  QVector<QCPGraphData> points(count);
+
+  // Výstupní vzorky, které už jsou v cache, se jen zkopírují. Vzorek z cache je spočítaný jen ze vstupů uvnitř
+  // tehdejšího úseku, takže se převezme, jen pokud se celý úsek vstupů potřebný pro daný výstup nezměnil;
+  // vzorky na okrajích (kam zasahuje délka filtru) se spočítají znovu.
+  int reusedBegin = 0, reusedEnd = 0;
+  InterpolationCache* cached = (chID >= 0 && chID < cache.size()) ? &cache[chID] : nullptr;
+  int shift;
+  if (cached && qAbs(cached->fs - fs) <= fs * 1e-9 && findCacheShift(*cached, keys, shift)) {
+    reusedBegin = qBound(0, -shift * upsampling, count);
+    reusedEnd = qBound(reusedBegin, cached->points.size() - shift * upsampling, count);
+    std::copy(cached->points.constBegin() + reusedBegin + shift * upsampling, cached->points.constBegin() + reusedEnd + shift * upsampling, points.begin() + reusedBegin);
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (i >= reusedBegin && i < reusedEnd)
+      continue;
+    int n = i + M / 2;
+    points[i].key = (begin + n / upsampling)->key + (n % upsampling) * resultSamplingPeriod;
+    points[i].value = filter(samples.constData(), i + M) * upsampling;
+  }
+
+  if (cached) {
+    cached->keys = keys;
+    cached->samples = samples;
+    cached->points = points;
+    cached->fs = fs;
+  }
 
   auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
-  for (int i = 0; i < values.size(); i++)
-    result->add(QCPGraphData((begin + (i + M / 2) / upsampling)->key + ((i + M / 2) % upsampling)*resultSamplingPeriod, values.at(i)*upsampling));
+  result->set(points, true);
 
   emit interpolationResult(chID, data, result, dataIsFromInterpolationBuffer);
   emit finished(chID);
@@ -90,23 +113,71 @@ void Interpolator::loadFilterFromFile(QString filename, int upsampling) {
   } else {
     qDebug() << "Failed to load " << filename;
   }
-}
 
-/// Provede konvoluci s odezvou (koeficienty) FIR filtru prvních M/2 a posledních M/2 vzorků je vynecháno (přechodné jevy).
-/// Výstup se tedy předbíhá o M/2 oproti vstupu (filtrovaný signál by se o M/2 zpožďoval, ale na začátku je vynecháno M vzorků)
-QVector<float> Interpolator::filter(QVector<float> x, QVector<float> h) {
-  QVector<float> y;
+  // Výsledky s jiným filtrem už neplatí
+  for (InterpolationCache &cached : cache)
+    cached = InterpolationCache();
+
+  polyphaseFIR.clear();
+  if (lowPassFIR.isEmpty())
+    return;
+  polyphaseFIR.resize(upsampling);
+  for (int phase = 0; phase < upsampling; phase++) {
+    QVector<float> &subfilter = polyphaseFIR[phase];
+    for (int k = phase; k < lowPassFIR.size(); k += upsampling)
+      subfilter.prepend(lowPassFIR.at(k));
+  }
+}
 
-  int N = x.length();     // Délka signálu
-  int M = h.length();     // Délka odezvy filtru
+void Interpolator::setInterpolation(int chID, bool enabled) {
+  if (!enabled && chID >= 0 && chID < cache.size())
+    cache[chID] = InterpolationCache();
+}
 
-  y.resize(N - M + 1);
+bool Interpolator::findCacheShift(const InterpolationCache &cached, const QVector<double> &keys, int &shift) const {
+  if (cached.keys.isEmpty() || keys.isEmpty())
+    return false;
 
-  for (int n = M - 1; n < N; n++) {
-    for (int k = 0; k < M; k++) {
-      y[n - M + 1] += x[n - k] * h[k];
-    }
+  // Vzájemná poloha podle času prvního vzorku jednoho z úseků ve druhém
+  if (keys.first() >= cached.keys.first()) {
+    int index = std::lower_bound(cached.keys.constBegin(), cached.keys.constEnd(), keys.first()) - cached.keys.constBegin();
+    if (index >= cached.keys.size() || cached.keys.at(index) != keys.first())
+      return false;
+    shift = index;
+  } else {
+    int index = std::lower_bound(keys.constBegin(), keys.constEnd(), cached.keys.first()) - keys.constBegin();
+    if (index >= keys.size() || keys.at(index) != cached.keys.first())
+      return false;
+    shift = -index;
   }
 
-  return y;
+  // Překrývající se vzorky musí být stejné
+  int from = MAX(0, -shift);
+  int to = MIN(keys.size(), cached.keys.size() - shift);
+  for (int i = from; i < to; i++)
+    if (keys.at(i) != cached.keys.at(i + shift) || samples.at(i) != cached.samples.at(i + shift))
+      return false;
+  return from < to;
+}
+
+/// Vzorek n konvoluce signálu (s vloženými upsampling - 1 nulami mezi vzorky) s odezvou FIR filtru.
+/// Nenulové jsou jen součiny s koeficienty jedné fáze, ty se násobí se souvislým úsekem vstupu.
+float Interpolator::filter(const float *x, int n) const {
+  const QVector<float> &subfilter = polyphaseFIR.at(n % upsampling);
+  const float *h = subfilter.constData();
+  int taps = subfilter.size();
+  x += n / upsampling - taps + 1;
+
+  // Čtyři nezávislé součty, aby překladač mohl použít vektorové instrukce
+  float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  int k = 0;
+  for (; k + 4 <= taps; k += 4) {
+    sum0 += x[k] * h[k];
+    sum1 += x[k + 1] * h[k + 1];
+    sum2 += x[k + 2] * h[k + 2];
+    sum3 += x[k + 3] * h[k + 3];
+  }
+  for (; k < taps; k++)
+    sum0 += x[k] * h[k];
+  return (sum0 + sum1) + (sum2 + sum3);
 }
@@ -30,8 +30,30 @@ class Interpolator : public QObject {
   /// Filtr pro filterování při interpolaci
   QVector<float> lowPassFIR;
 
-  /// Konvoluce signálu x s odezvou filtru h
-  QVector<float> filter(QVector<float> x, QVector<float> h);
+  /// Filtr rozdělený na fáze (polyphase): fáze p obsahuje koeficienty p, p + upsampling, p + 2 * upsampling...
+  /// v obráceném pořadí, takže se násobí se souvislým úsekem vstupních vzorků (vložené nuly se vůbec nepočítají).
+  QVector<QVector<float>> polyphaseFIR;
+
+  /// Vstupní vzorky (bez vložených nul), pomocný buffer
+  QVector<float> samples;
+
+  /// Vzorek n signálu s vloženými nulami po filtraci (n >= lowPassFIR.size() - 1)
+  inline float filter(const float *x, int n) const;
+
+  /// Výsledek poslední interpolace kanálu. Při další interpolaci se znovu počítají jen výstupní vzorky,
+  /// které nebyly celé spočítané ze stejných vstupních vzorků (nově přidané nebo odkryté úseky).
+  struct InterpolationCache {
+    QVector<double> keys;
+    QVector<float> samples;
+    /// Výstup, vzorek i odpovídá vzorku i + M konvoluce (M je řád filtru)
+    QVector<QCPGraphData> points;
+    double fs = 0;
+  };
+  QVector<InterpolationCache> cache;
+
+  /// Vrátí posun indexů vstupu v cache oproti novým vstupním vzorkům (index v cache = index nový + posun),
+  /// nebo false, pokud se překrývající vzorky liší (data byla nahrazena) nebo se nepřekrývají vůbec.
+  bool findCacheShift(const InterpolationCache &cached, const QVector<double> &keys, int &shift) const;
 
   int upsampling = 8;
 
@@ -43,6 +65,9 @@ class Interpolator : public QObject {
 
   void loadFilterFromFile(QString filename, int upsampling);
 
+  /// Při vypnutí interpolace kanálu zahodí jeho cache
+  void setInterpolation(int chID, bool enabled);
+
  signals:
   /// Odešle interpolovaný průběh, pokud data z kterých byla interpolace počítána pochází z bufferu (přidávání po celých kanálech, jsou
   /// v grafu prepsány i původní vzorky, aby odpovídali průběhu z kterého je vypočtena interpolace. Pokud byla data vzata přímo z grafu,
@@ -15,15 +15,70 @@
 
 #include "plotmath.h"
 
+/// Jeden vzorek výsledku, operace je známá při překladu
+template <MathOperations::enumMathOperations operation> static inline double applyOperation(double first, double second) {
+  if constexpr (operation == MathOperations::add)
+    return first + second;
+  else if constexpr (operation == MathOperations::subtract)
+    return first - second;
+  else if constexpr (operation == MathOperations::multiply)
+    return first * second;
+  else
+    return first / second;
+}
+
+/// Výpočet celého kanálu. Operace a konstantnost vstupů jsou parametry šablony, ve smyčce se tak nic nerozhoduje
+/// a překladač ji může vektorizovat pro cílovou platformu. Konstantní vstup se nečte (ukazatel může být nullptr).
+template <MathOperations::enumMathOperations operation, bool constFirst, bool constSecond>
+static void mathKernel(const QCPGraphData *first, const QCPGraphData *second, const QCPGraphData *keys, QCPGraphData *result, int count, double scaleFirst, double scaleSecond) {
+  for (int i = 0; i < count; i++) {
+    double a = constFirst ? scaleFirst : first[i].value * scaleFirst;
+    double b = constSecond ? scaleSecond : second[i].value * scaleSecond;
+    result[i].key = keys[i].key;
+    result[i].value = applyOperation<operation>(a, b);
+  }
+}
+
+typedef void (*MathKernel)(const QCPGraphData *, const QCPGraphData *, const QCPGraphData *, QCPGraphData *, int, double, double);
+
+template <MathOperations::enumMathOperations operation> static MathKernel selectMathKernel(bool constFirst, bool constSecond) {
+  if (constFirst)
+    return constSecond ? mathKernel<operation, true, true> : mathKernel<operation, true, false>;
+  return constSecond ? mathKernel<operation, false, true> : mathKernel<operation, false, false>;
+}
+
+static MathKernel selectMathKernel(MathOperations::enumMathOperations operation, bool constFirst, bool constSecond) {
+  switch (operation) {
+    case MathOperations::add:
+      return selectMathKernel<MathOperations::add>(constFirst, constSecond);
+    case MathOperations::subtract:
+      return selectMathKernel<MathOperations::subtract>(constFirst, constSecond);
+    case MathOperations::multiply:
+      return selectMathKernel<MathOperations::multiply>(constFirst, constSecond);
+    default:
+      return selectMathKernel<MathOperations::divide>(constFirst, constSecond);
+  }
+}
+
 PlotMath::PlotMath(QObject* parent) : QObject(parent) {
   firsts.resize(MATH_COUNT);
   seconds.resize(MATH_COUNT);
-  for (int i = 0; i < MATH_COUNT; i++)
+  for (int i = 0; i < MATH_COUNT; i++) {
     operations[i] = MathOperations::add;
+    expressions[i] = new CompiledExpression(this);
+  }
 }
 
 PlotMath::~PlotMath() {}
 
+QStringList PlotMath::expressionVariables() {
+  QStringList variables;
+  variables.append("t");
+  for (int i = 1; i <= ANALOG_COUNT; i++)
+    variables.append(QString("ch%1").arg(i));
+  return variables;
+}
+
 void PlotMath::addMathData(int mathNumber, bool isFirst, QSharedPointer<QCPGraphDataContainer> in, bool shouldIgnorePause) {
   QSharedPointer<QCPGraphDataContainer>& first = firsts[mathNumber];
   QSharedPointer<QCPGraphDataContainer>& second = seconds[mathNumber];
@@ -46,27 +101,97 @@ void PlotMath::addMathData(int mathNumber, bool isFirst, QSharedPointer<QCPGraph
     }
   }
 
-  auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer());
-  for (int i = 0; i < first->size(); i++) {
-    double resultSample = (isconstFirst[mathNumber] ? 1.0 : first->at(i)->value) * scalarsFirst[mathNumber];
-    if (operations[mathNumber] == MathOperations::add)
-      resultSample += (isconstSeconds[mathNumber] ? 1.0 : second->at(i)->value) * scalarsSeconds[mathNumber];
-    else if (operations[mathNumber] == MathOperations::subtract)
-      resultSample -= (isconstSeconds[mathNumber] ? 1.0 : second->at(i)->value) * scalarsSeconds[mathNumber];
-    else if (operations[mathNumber] == MathOperations::multiply)
-      resultSample *= (isconstSeconds[mathNumber] ? 1.0 : second->at(i)->value) * scalarsSeconds[mathNumber];
-    else if (operations[mathNumber] == MathOperations::divide)
-      resultSample /= (isconstSeconds[mathNumber] ? 1.0 : second->at(i)->value) * scalarsSeconds[mathNumber];
-    result->add(QCPGraphData(first->at(i)->key, resultSample));
+  // Časy vzorků se berou z prvního nekonstantního vstupu
+  bool constFirst = isconstFirst[mathNumber];
+  bool constSecond = isconstSeconds[mathNumber];
+  const QSharedPointer<QCPGraphDataContainer> &keys = (!constFirst || (constSecond && !first.isNull())) ? first : second;
+  if (keys.isNull())
+    return;
+
+  int count = keys->size();
+  QVector<QCPGraphData> points(count);
+  if (count > 0) {
+    // Operace a konstantnost vstupů se vyřeší jednou pro celý kanál
+    MathKernel kernel = selectMathKernel(operations[mathNumber], constFirst, constSecond);
+    kernel(constFirst ? nullptr : &*first->constBegin(), constSecond ? nullptr : &*second->constBegin(), &*keys->constBegin(), points.data(), count, scalarsFirst[mathNumber], scalarsSeconds[mathNumber]);
   }
+  auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer());
+  result->set(points, true);
   emit sendResult(getAnalogChId(mathNumber + 1, ChannelType::math), result, shouldIgnorePause);
   first.clear();
   second.clear();
 }
 
+void PlotMath::addMathExpressionData(int mathNumber, int input, QSharedPointer<QCPGraphDataContainer> in, bool shouldIgnorePause) {
+  QVector<QSharedPointer<QCPGraphDataContainer>>& inputs = expressionInputs[mathNumber];
+  if (input < 0 || input >= inputs.size())
+    return;
+  inputs[input] = in;
+
+  for (const auto& data : qAsConst(inputs))
+    if (data.isNull())
+      return;
+
+  int count = inputs.first()->size();
+  for (const auto& data : qAsConst(inputs)) {
+    if (data->size() != count) {
+      emit sendMessage(tr("Math error"), tr("Channels have different length, can not use math").toUtf8());
+      inputs.fill(QSharedPointer<QCPGraphDataContainer>());
+      return;
+    }
+  }
+
+  QVector<QCPGraphData> points(count);
+  if (count > 0) {
+    // Proměnné ukazují přímo do dat kanálů (QCPGraphData je dvojice key, value, proto krok 2)
+    QVector<CompiledExpression::Variable> variables(ANALOG_COUNT + 1);
+    variables[0] = {&inputs.first()->constBegin()->key, 2};
+    for (int i = 0; i < inputs.size(); i++)
+      variables[expressionChannels[mathNumber].at(i)] = {&inputs.at(i)->constBegin()->value, 2};
+
+    // Průběh se přepočítává celý, klouzavé průměry proto začínají znovu (jediný bod navazuje na předchozí)
+    if (count > 1)
+      expressions[mathNumber]->reset();
+    QVector<double> values(count);
+    expressions[mathNumber]->evaluate(variables, count, values.data());
+
+    auto key = inputs.first()->constBegin();
+    for (int i = 0; i < count; i++, key++)
+      points[i] = QCPGraphData(key->key, values.at(i));
+  }
+  auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer());
+  result->set(points, true);
+  emit sendResult(getAnalogChId(mathNumber + 1, ChannelType::math), result, shouldIgnorePause);
+  inputs.fill(QSharedPointer<QCPGraphDataContainer>());
+}
+
 void PlotMath::clearMath(int math) {
   firsts[math - 1].clear();
   seconds[math - 1].clear();
+  expressionInputs[math - 1].fill(QSharedPointer<QCPGraphDataContainer>());
+}
+
+void PlotMath::resetMathExpression(int mathNumber, QString expression, QList<QSharedPointer<QCPGraphDataContainer>> inputs) {
+  CompiledExpression* compiled = expressions[mathNumber - 1];
+  if (!compiled->compile(expression, expressionVariables())) {
+    expressionChannels[mathNumber - 1].clear();
+    expressionInputs[mathNumber - 1].clear();
+    return;
+  }
+  compiled->reset();
+
+  expressionChannels[mathNumber - 1].clear();
+  for (int variable : compiled->usedVariables())
+    if (variable > 0)
+      expressionChannels[mathNumber - 1].append(variable);
+  expressionInputs[mathNumber - 1].fill(QSharedPointer<QCPGraphDataContainer>(), expressionChannels[mathNumber - 1].size());
+  if (inputs.size() != expressionChannels[mathNumber - 1].size() || inputs.isEmpty())
+    return;
+
+  // Vloží data všech vstupů, poslední vstup spustí výpočet
+  for (int i = 0; i < inputs.size() - 1; i++)
+    expressionInputs[mathNumber - 1][i] = inputs.at(i);
+  addMathExpressionData(mathNumber - 1, inputs.size() - 1, inputs.last(), true);
 }
 
 void PlotMath::resetMath(int mathNumber, MathOperations::enumMathOperations mode, QSharedPointer<QCPGraphDataContainer> in1, QSharedPointer<QCPGraphDataContainer> in2, bool firstIsConst, bool secondIsConst, double scaleFirst, double scaleSecond) {
@@ -21,6 +21,7 @@
 #include <QThread>
 
 #include "global.h"
+#include "math/compiledexpression.h"
 #include "plots/qcustomplot.h"
 
 class PlotMath : public QObject {
@@ -28,6 +29,8 @@ class PlotMath : public QObject {
  public:
   explicit PlotMath(QObject* parent = nullptr);
   ~PlotMath();
+  /// Názvy proměnných použitelných ve vzorci (čas "t" má index 0, kanál chN index N)
+  static QStringList expressionVariables();
 
  private:
   QVector<QSharedPointer<QCPGraphDataContainer>> firsts, seconds = QVector<QSharedPointer<QCPGraphDataContainer>>();
@@ -36,9 +39,16 @@ class PlotMath : public QObject {
   bool isconstSeconds[MATH_COUNT];
   double scalarsFirst[MATH_COUNT];
   double scalarsSeconds[MATH_COUNT];
+  /// Přeložené vzorce matematických kanálů
+  CompiledExpression *expressions[MATH_COUNT];
+  /// Kanály použité ve vzorci a jejich aktuálně přijatá data (pořadí odpovídá číslu vstupu)
+  QList<int> expressionChannels[MATH_COUNT];
+  QVector<QSharedPointer<QCPGraphDataContainer>> expressionInputs[MATH_COUNT];
  public slots:
   void addMathData(int mathNumber, bool isFirst, QSharedPointer<QCPGraphDataContainer> in, bool shouldIgnorePause);
+  void addMathExpressionData(int mathNumber, int input, QSharedPointer<QCPGraphDataContainer> in, bool shouldIgnorePause);
   void clearMath(int math);
+  void resetMathExpression(int mathNumber, QString expression, QList<QSharedPointer<QCPGraphDataContainer>> inputs);
   void resetMath(int mathNumber, MathOperations::enumMathOperations mode, QSharedPointer<QCPGraphDataContainer> in1, QSharedPointer<QCPGraphDataContainer> in2, bool firstIsConst, bool secondIsConst, double scaleFirst, double scaleSecond);
 
  signals:
@@ -17,6 +17,40 @@
 
 SignalProcessing::SignalProcessing(QObject *parent) : QObject(parent) {}
 
+class SignalProcessing::WelchSegmentsTask : public QRunnable {
+ public:
+  WelchSegmentsTask(const QCPGraphData *samples, double dc, int firstSegment, int segmentCount, int halfSegmentLength, const QVector<double> *window, int nfft, const FFTTables &tables, QVector<double> *sum, QSemaphore *done)
+      : samples(samples), dc(dc), firstSegment(firstSegment), segmentCount(segmentCount), halfSegmentLength(halfSegmentLength), window(window), nfft(nfft), tables(tables), sum(sum), done(done) {}
+
+  void run() override {
+    // Segmenty se nekopírují, čtou se přímo z dat kanálu (jen vynásobené oknem do pomocného bufferu)
+    int segmentLength = 2 * halfSegmentLength;
+    QVector<double> windowed(segmentLength);
+    QVector<std::complex<double>> spectrum;
+    sum->fill(0, nfft);
+    for (int segment = firstSegment; segment < firstSegment + segmentCount; segment++) {
+      const QCPGraphData *segmentSamples = samples + segment * halfSegmentLength;
+      for (int i = 0; i < segmentLength; i++)
+        windowed[i] = window ? (segmentSamples[i].value - dc) * window->at(i) : segmentSamples[i].value - dc;
+      realFFT(windowed.constData(), segmentLength, nfft, tables, spectrum);
+      // Přičte |x|^2
+      for (int i = 0; i < nfft; i++)
+        (*sum)[i] += std::norm(spectrum.at(i));
+    }
+    done->release();
+  }
+
+ private:
+  const QCPGraphData *samples;
+  double dc;
+  int firstSegment, segmentCount, halfSegmentLength;
+  const QVector<double> *window;
+  int nfft;
+  const FFTTables &tables;
+  QVector<double> *sum;
+  QSemaphore *done;
+};
+
 void SignalProcessing::resizeHamming(int length) {
   if (hamming.size() != length) {
     hamming.resize(length);
@@ -41,55 +75,112 @@ void SignalProcessing::resizeBlackman(int length) {
   }
 }
 
-QVector<std::complex<double>> SignalProcessing::fft(QVector<std::complex<double>> x) {
-  int N = x.size(); // Velikost x musí být mocnina 2.
-
-  if (N == 1)
-    return x; // Konec rekurze
+const SignalProcessing::FFTTables &SignalProcessing::getFFTTables(int nfft) {
+  auto it = fftTables.find(nfft);
+  if (it != fftTables.end())
+    return it.value();
+
+  // Délky se mění jen při změně nastavení, starší tabulky není potřeba držet
+  if (fftTables.size() >= 8)
+    fftTables.clear();
+
+  FFTTables &tables = fftTables[nfft];
+  int half = nfft / 2;
+  tables.twiddles.resize(half);
+  for (int k = 0; k < half; k++) {
+    double arg = -2 * M_PI * k / nfft;
+    tables.twiddles[k] = std::complex<double>(cos(arg), sin(arg));
+  }
 
-  QVector<std::complex<double>> Pe, Po; // Sudé a liché koeficienty
-  for (int n = 1; n < N; n += 2) {
-    Pe.append(x.at(n - 1)); // Sudé
-    Po.append(x.at(n));     // Liché
+  int bits = 0;
+  while ((1 << bits) < half)
+    bits++;
+  tables.bitReverse.resize(half);
+  for (int i = 0; i < half; i++) {
+    int reversed = 0;
+    for (int b = 0; b < bits; b++)
+      if (i & (1 << b))
+        reversed |= 1 << (bits - 1 - b);
+    tables.bitReverse[i] = reversed;
   }
+  return tables;
+}
 
-  QVector<std::complex<double>> Xe = fft(Pe), Xo = fft(Po); // Rekurze
+void SignalProcessing::complexFFT(std::complex<double> *x, int n, const FFTTables &tables) {
+  // Iterativní radix-2 FFT na místě, n je polovina délky, pro kterou jsou tabulky
+  const int *bitReverse = tables.bitReverse.constData();
+  for (int i = 0; i < n; i++) {
+    int j = bitReverse[i];
+    if (i < j)
+      std::swap(x[i], x[j]);
+  }
 
-  QVector<std::complex<double>> X;
-  X.resize(N);
-  for (int k = 0; k < N / 2; k++) {
+  const std::complex<double> *twiddles = tables.twiddles.constData();
+  for (int len = 2; len <= n; len <<= 1) {
+    int half = len / 2;
+    int step = 2 * (n / len); // Tabulka je pro dvojnásobnou délku
+    for (int i = 0; i < n; i += len) {
+      for (int k = 0; k < half; k++) {
+        std::complex<double> u = x[i + k];
+        std::complex<double> v = x[i + k + half] * twiddles[k * step];
+        x[i + k] = u + v;
+        x[i + k + half] = u - v;
+      }
+    }
+  }
+}
 
-    // exp(i*2*Pi*k/N)
-    double arg = M_PI * 2 * k / N;
-    std::complex<double> WNk(cos(arg), sin(arg));
+void SignalProcessing::realFFT(const double *signal, int length, int nfft, const FFTTables &tables, QVector<std::complex<double>> &spectrum) {
+  spectrum.fill(std::complex<double>(0, 0), nfft);
+  if (nfft < 2) {
+    if (nfft == 1 && length > 0)
+      spectrum[0] = signal[0];
+    return;
+  }
 
-    X[k] = Xe[k] + WNk * Xo[k];
-    X[k + N / 2] = Xe[k] - WNk * Xo[k];
+  // Sudé vzorky jako reálná a liché jako imaginární část, FFT poloviční délky
+  int half = nfft / 2;
+  std::complex<double> *X = spectrum.data();
+  for (int m = 0; m < half; m++)
+    X[m] = std::complex<double>(2 * m < length ? signal[2 * m] : 0, 2 * m + 1 < length ? signal[2 * m + 1] : 0);
+
+  complexFFT(X, half, tables);
+
+  // Rozdělení na spektra sudých a lichých vzorků a jejich složení (dvojice k, half - k se počítají najednou, aby šlo přepisovat na místě)
+  const std::complex<double> *twiddles = tables.twiddles.constData();
+  std::complex<double> z0 = X[0];
+  X[0] = std::complex<double>(z0.real() + z0.imag(), 0);
+  X[half] = std::complex<double>(z0.real() - z0.imag(), 0);
+  for (int k = 1; k <= half / 2; k++) {
+    std::complex<double> a = X[k], b = X[half - k];
+    std::complex<double> even = (a + std::conj(b)) * 0.5, odd = (a - std::conj(b)) * std::complex<double>(0, -0.5);
+    std::complex<double> evenMirror = (b + std::conj(a)) * 0.5, oddMirror = (b - std::conj(a)) * std::complex<double>(0, -0.5);
+    X[k] = even + twiddles[k] * odd;
+    X[half - k] = evenMirror + twiddles[half - k] * oddMirror;
   }
-  return X;
+
+  // Spektrum reálného signálu je symetrické
+  for (int k = 1; k < half; k++)
+    X[nfft - k] = std::conj(X[k]);
 }
 
-void SignalProcessing::getFFTPlot(QSharedPointer<QCPGraphDataContainer> data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int segmentCount, bool twosided, bool zerocenter, int minNFFT) {
+void SignalProcessing::getFFTPlot(ChannelSnapshot data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int segmentCount, bool twosided, bool zerocenter, int minNFFT) {
+  // Stejnosměrná složka (snímek se nesmí měnit, odečítá se až při čtení vzorků)
+  double dc = 0;
   if (removeDC) {
-    // Stejnosměrná složka
-    double dc = 0;
-    for (QCPGraphDataContainer::iterator it = data->begin(); it != data->end(); it++)
+    for (auto it = data.constBegin(); it != data.constEnd(); it++)
       dc += it->value;
-    dc /= data->size();
-
-    // Odstranění stejnosměrné složky
-    for (QCPGraphDataContainer::iterator it = data->begin(); it != data->end(); it++)
-      it->value -= dc;
+    dc /= data.size();
   }
 
-  double fs = data->size() / (data->at(data->size() - 1)->key - data->at(0)->key);
+  double fs = data.size() / (data.at(data.size() - 1).key - data.at(0).key);
 
   if (type == FFTType::spectrum || type == FFTType::periodogram) {
-    QVector<std::complex<double>> values;
-    for (int i = 0; i < data->size(); i++)
-      values.append(std::complex<double>(data->at(i)->value, 0));
+    QVector<double> values(data.size());
+    for (int i = 0; i < data.size(); i++)
+      values[i] = data.at(i).value - dc;
 
-    double normalization = data->size();
+    double normalization = data.size();
     if (window == FFTWindow::hamming)
       normalization *= 0.54;
     else if (window == FFTWindow::hann)
@@ -98,7 +189,7 @@ void SignalProcessing::getFFTPlot(QSharedPointer<QCPGraphDataContainer> data, FF
       normalization *= 0.42;
     double normalizationSquared = normalization * normalization;
 
-    QVector<std::complex<double>> resultValues = calculateSpectrum(values, window, minNFFT);
+    QVector<std::complex<double>> resultValues = calculateSpectrum(values.constData(), values.size(), window, minNFFT);
     int nfft = resultValues.size();
 
     auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
@@ -123,7 +214,7 @@ void SignalProcessing::getFFTPlot(QSharedPointer<QCPGraphDataContainer> data, FF
 
     // Rozdělení na segmenty s 50% překryvem
     //  Kolik půl-segmentů se vejde?
-    int halfSegmentLength = data->size() / segmentCount;
+    int halfSegmentLength = data.size() / segmentCount;
     // Pokud je počet půlsegmentů sudý, poslední překryvný se nevejde, bude o jeden méně, než se chtělo
     // |___ ___ ___ ___ ___ _|
     // |  ___ ___ ___ ___ ___|
@@ -132,17 +223,9 @@ void SignalProcessing::getFFTPlot(QSharedPointer<QCPGraphDataContainer> data, FF
     // |___ ___ ___ ___ ___|
     // |  ___ ___ ___ ___   |
     // V horní řadě je 5 celých segmentů (sudý počet půlsegmentů), do spodní se vejde je 4
-    if ((data->size() / halfSegmentLength) % 2 == 0)
+    if ((data.size() / halfSegmentLength) % 2 == 0)
       segmentCount--;
 
-    // Rozdělení na segmenty
-    QVector<QVector<std::complex<double>>> segments;
-    segments.resize(segmentCount);
-    for (int i = 0; i < segments.size(); i++) {
-      for (int j = i * halfSegmentLength; j < (i + 2) * halfSegmentLength; j++)
-        segments[i].append(std::complex<double>(data->at(j)->value, 0));
-    }
-
     double normalization = 2 * halfSegmentLength;
     if (window == FFTWindow::hamming)
       normalization *= 0.54;
@@ -153,114 +236,135 @@ void SignalProcessing::getFFTPlot(QSharedPointer<QCPGraphDataContainer> data, FF
     double normalizationSquared = normalization * normalization;
 
     // Výpočet spektra pro jednotlivé segmenty
-    // Funkce calculateSpectrum použije okno a doplní nulami na mocninu dvou
-    for (int i = 0; i < segments.size(); i++) {
-      segments[i] = calculateSpectrum(segments.at(i), window, minNFFT);
+    // Segment i začíná na vzorku i * halfSegmentLength a má délku 2 * halfSegmentLength (50% překryv).
+    // Segmenty se rozdělí do úloh ve sdíleném poolu vláken, každá úloha sčítá |x|^2 svých segmentů do vlastního vektoru.
+    int segmentLength = 2 * halfSegmentLength;
+    int nfft = nextPow2(MAX(segmentLength, minNFFT));
+    const QVector<double> *windowValues = getWindow(window, segmentLength);
+    const FFTTables &tables = getFFTTables(nfft);
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    int taskCount = MIN(segmentCount, 2 * MAX(pool->maxThreadCount(), 1));
+    QVector<QVector<double>> partialSums(taskCount);
+    QSemaphore done;
+    for (int task = 0, firstSegment = 0; task < taskCount; task++) {
+      int count = (segmentCount - firstSegment) / (taskCount - task);
+      pool->start(new WelchSegmentsTask(&*data.constBegin(), dc, firstSegment, count, halfSegmentLength, windowValues, nfft, tables, &partialSums[task], &done));
+      firstSegment += count;
     }
+    done.acquire(taskCount);
 
-    int nfft = segments.at(0).length();
+    QVector<double> sum = partialSums.at(0);
+    for (int task = 1; task < taskCount; task++)
+      for (int i = 0; i < nfft; i++)
+        sum[i] += partialSums.at(task).at(i);
 
     // Výpočet periodogramů a zprůměrování
     auto result = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
     double freqStep = fs / nfft;
     for (int i = 0; (twosided ? (i < nfft) : (i <= nfft / 2)); i++) {
-      double value = 0;
+      double value = sum.at(i);
       double freq = i * freqStep;
       if (zerocenter && i > nfft / 2)
         freq -= nfft * freqStep;
-      for (int j = 0; j < segments.size(); j++)
-        // Přičte k value |x|^2, Výpočet |x|^2 jako x * komplexně sdružené x;
-        value += (segments.at(j).at(i) * std::complex<double>(segments.at(j).at(i).real(), -segments.at(j).at(i).imag())).real();
       // Přidá do výsledku bod - součet hodnot ze segmentů dělený nfft a počtem segmentů. V dB.
-      result->add(QCPGraphData(freq, 10 * log10(value / normalizationSquared / segments.size())));
+      result->add(QCPGraphData(freq, 10 * log10(value / normalizationSquared / segmentCount)));
     }
     emit fftResult(result);
   }
 }
 
-QVector<std::complex<double>> SignalProcessing::calculateSpectrum(QVector<std::complex<double>> data, FFTWindow::enumFFTWindow window, int minNFFT) {
+const QVector<double> *SignalProcessing::getWindow(FFTWindow::enumFFTWindow window, int length) {
   if (window == FFTWindow::hamming) {
-    resizeHamming(data.size());
-    for (int i = 0; i < data.size(); i++)
-      data[i] *= hamming.at(i);
-  } else if (window == FFTWindow::hann) {
-    resizeHann(data.size());
-    for (int i = 0; i < data.size(); i++)
-      data[i] *= hann.at(i);
-  } else if (window == FFTWindow::blackman) {
-    resizeBlackman(data.size());
-    for (int i = 0; i < data.size(); i++)
-      data[i] *= blackman.at(i);
+    resizeHamming(length);
+    return &hamming;
   }
-
-  int nfft = nextPow2(data.size());
-  if (nfft < minNFFT)
-    nfft = minNFFT;
-  data.resize(nfft);
-
-  return fft(data);
+  if (window == FFTWindow::hann) {
+    resizeHann(length);
+    return &hann;
+  }
+  if (window == FFTWindow::blackman) {
+    resizeBlackman(length);
+    return &blackman;
+  }
+  return nullptr;
 }
 
-void SignalProcessing::process(QSharedPointer<QCPGraphDataContainer> data) {
-  bool rangefound = false; // Nevyužité, ale je potřeba do funkcí co hledají max/min
-  auto valRange = data->valueRange(rangefound);
-  double max = valRange.upper;
-  double min = valRange.lower;
+QVector<std::complex<double>> SignalProcessing::calculateSpectrum(const double *data, int length, FFTWindow::enumFFTWindow window, int minNFFT) {
+  const double *signal = data;
+  const QVector<double> *windowValues = getWindow(window, length);
+  if (windowValues) {
+    windowedSignal.resize(length);
+    for (int i = 0; i < length; i++)
+      windowedSignal[i] = data[i] * windowValues->at(i);
+    signal = windowedSignal.constData();
+  }
 
-  double dc_full = 0;
-  for (QCPGraphDataContainer::iterator it = data->begin(); it != data->end(); it++)
-    dc_full += it->value;
-  dc_full /= data->size();
+  int nfft = nextPow2(MAX(length, minNFFT));
 
-  double fs = (data->size() - 1) / (data->at(data->size() - 1)->key - data->at(0)->key);
+  QVector<std::complex<double>> spectrum;
+  realFFT(signal, length, nfft, getFFTTables(nfft), spectrum);
+  return spectrum;
+}
 
-  double freq = getStrongestFreq(data, dc_full, fs);
+void SignalProcessing::process(ChannelSnapshot data) {
+  // Statistiky se aktualizují jen o vzorky, které od minulého měření přibyly nebo ubyly
+  qint64 changed = statistics.update(data);
+  StreamingStatistics::Stats total = statistics.total();
+  double max = total.max;
+  double min = total.min;
+  double dc_full = total.mean;
+
+  double fs = (data.size() - 1) / (data.at(data.size() - 1).key - data.at(0).key);
+
+  // Dominantní frekvence (FFT) se přepočítá, jen když se změnila dostatečná část signálu
+  if (changed >= 0)
+    changedSinceFreq += changed;
+  if (changed < 0 || qIsNaN(lastFreq) || changedSinceFreq * MEASUREMENT_FREQ_REFRESH_RATIO >= data.size()) {
+    lastFreq = getStrongestFreq(data, dc_full, fs);
+    changedSinceFreq = 0;
+  }
+  double freq = lastFreq;
 
   double period = 1.0 / freq;
 
-  int samples = data->size();
+  int samples = data.size();
 
   // Remove non-integer period part from beginning of signal
-  auto keyRange = data->keyRange(rangefound);
-  double N_periods = floor(keyRange.size() / period);
+  double lastKey = data.at(data.size() - 1).key;
+  double N_periods = floor((lastKey - data.at(0).key) / period);
+  int periodsBegin = 0;
   if (!qIsNull(N_periods) && !qIsInf(N_periods))
-    data->removeBefore(data->at(data->size() - 1)->key - N_periods * period);
-
-  // Stejnosměrná složka
-  double dc = 0;
-  for (QCPGraphDataContainer::iterator it = data->begin(); it != data->end(); it++)
-    dc += it->value;
-  dc /= data->size();
+    periodsBegin = data.findBegin(lastKey - N_periods * period);
 
-  // Efektivní hodnota
-  double vrms = 0;
-  for (QCPGraphDataContainer::iterator it = data->begin(); it != data->end(); it++)
-    vrms += (it->value * it->value);
-  vrms /= data->size();
-  vrms = sqrt(vrms);
+  // Stejnosměrná složka a efektivní hodnota (z bloků statistik, přímo se sčítá jen začátek prvního bloku)
+  StreamingStatistics::Stats periods = statistics.tail(data, periodsBegin);
+  double dc = periods.mean;
+  double vrms = periods.rms();
 
   // Od teď se počítá jen s posledními dvěma periodami !!!
   if (N_periods > 2 && !qIsInf(N_periods))
-    data->removeBefore(data->at(data->size() - 1)->key - 2.0 * period);
+    data.limitBefore(lastKey - 2.0 * period);
 
   auto risefall = getRiseFall(data);
 
   emit result(period, freq, (max - min), min, max, vrms, dc, fs, risefall.first, risefall.second, samples);
 }
 
-double SignalProcessing::getStrongestFreq(QSharedPointer<QCPGraphDataContainer> data, double dc, double fs) {
+double SignalProcessing::getStrongestFreq(const ChannelSnapshot &data, double dc, double fs) {
 
   // Prostě udělám FFT (po odečtení DC) a najdu globální maximum
-  QVector<std::complex<double>> acValues;
-  for (int i = 0; i < data->size(); i++)
-    acValues.append((data->at(i)->value - dc));
+  QVector<double> acValues(data.size());
+  for (int i = 0; i < data.size(); i++)
+    acValues[i] = data.at(i).value - dc;
 
   int nfft = acValues.size() * 5;
 
   nfft = nextPow2(nfft);
 
-  acValues.resize(nfft);
-  QVector<std::complex<double>> acSigFFT = fft(acValues);
+  const FFTTables &tables = getFFTTables(nfft);
+  QVector<std::complex<double>> acSigFFT;
+  realFFT(acValues.constData(), acValues.size(), nfft, tables, acSigFFT); // Doplnění nulami na nfft
 
   int maxindex = 0;
   double maxVal = 0;
@@ -275,42 +379,58 @@ double SignalProcessing::getStrongestFreq(QSharedPointer<QCPGraphDataContainer>
   double freq = maxindex * fs / nfft;
 
   if (freq < fs * (1 + sqrt(4 * nfft + 1)) / (2 * nfft)) {
-    int aproxIndex = fs / freq;
+    // Frekvence je v nejnižších binech FFT, přesněji se určí z autokorelace
+    int N = acValues.size();
+    int aproxIndex = maxindex > 0 ? fs / freq : N - 1;
     int aproxMin = (aproxIndex * 90) / 100;
     int aproxMax = (aproxIndex * 110) / 100;
-    acValues.resize(data->size()); // Odstranění doplněných nul
 
-    int N = acValues.size();
+    if (aproxMin < 1)
+      aproxMin = 1;
+    if (aproxMax >= N - 1)
+      aproxMax = N - 2;
 
-    if (aproxMin < 0)
-      aproxMin = 0;
-    if (aproxMax >= N)
-      aproxMax = N - 1;
+    // Autokorelace jako zpětná FFT výkonového spektra (Wiener-Chinčin), spektrum už je spočítané.
+    // Signál je doplněný nulami na víc než dvojnásobnou délku, takže jde o lineární (ne kruhovou) autokorelaci.
+    // Výkonové spektrum je reálné a sudé, zpětná FFT je tedy stejná jako dopředná (až na dělení nfft, které nevadí).
+    QVector<double> power(nfft);
+    for (int i = 0; i < nfft; i++)
+      power[i] = std::norm(acSigFFT.at(i));
+    QVector<std::complex<double>> autocorrelation;
+    realFFT(power.constData(), nfft, nfft, tables, autocorrelation);
 
     double highestValue = -Q_INFINITY;
     int highestIndex = 0;
 
     for (int k = aproxMin; k <= aproxMax; k++) {
-      double val = 0;
-      for (int n = 0; n < N - k; n++)
-        val += acValues.at(n + k).real() * acValues.at(n).real();
+      double val = autocorrelation.at(k).real();
       if (val > highestValue) {
         highestIndex = k;
         highestValue = val;
       }
     }
-    freq = fs / highestIndex;
+
+    // Zpřesnění polohy vrcholu proložením paraboly sousedními hodnotami
+    double lag = highestIndex;
+    if (highestIndex > 0 && highestIndex < nfft - 1) {
+      double left = autocorrelation.at(highestIndex - 1).real();
+      double right = autocorrelation.at(highestIndex + 1).real();
+      double curvature = left - 2 * highestValue + right;
+      if (curvature < 0)
+        lag += 0.5 * (left - right) / curvature;
+    }
+    freq = fs / lag;
   }
   return (freq);
 }
 
-QPair<double, double> SignalProcessing::getRiseFall(QSharedPointer<QCPGraphDataContainer> data) {
+QPair<double, double> SignalProcessing::getRiseFall(const ChannelSnapshot &data) {
   auto risefall = QPair<double, double>(Q_QNAN, Q_QNAN);
 
   // Zde se počítá je s posledními dvěma periodami (aby se zamezil vliv náhodných špiček na min/max)
-  bool rangefound = false; // Nevyužité, ale je potřeba do funkcí co hledají max/min
-  double max = data->valueRange(rangefound).upper;
-  double min = data->valueRange(rangefound).lower;
+  QCPRange valRange = data.valueRange();
+  double max = valRange.upper;
+  double min = valRange.lower;
 
   double top = min + 0.9 * (max - min);    // 90 %
   double bottom = min + 0.1 * (max - min); // 10 %
@@ -320,17 +440,17 @@ QPair<double, double> SignalProcessing::getRiseFall(QSharedPointer<QCPGraphDataC
 
   // postupuje se od konce - platí poslední vzestup/sestup
   // vzestup
-  for (int i = data->size() - 1; i >= 0; i--) {
-    if (data->at(i)->value >= top)
+  for (int i = data.size() - 1; i >= 0; i--) {
+    if (data.at(i).value >= top)
       riseEnd = i; // Je nad 90 %
     else if (riseEnd != -1) {
       // Konec už mám, tohle může být začátek, pokud je pod 10 %
-      if (data->at(i)->value <= bottom) {
+      if (data.at(i).value <= bottom) {
         // Je to začátek (první před koncem co je pod 10 %)
         // Aby to fungovalo i pro málo vzorků, tak to podle začátku a konce
         // nahradím přímkou a spočítám za jak dlouho naroste z min na max
-        QCPGraphData end = *data->at(riseEnd);
-        QCPGraphData begin = *data->at(i);
+        QCPGraphData end = data.at(riseEnd);
+        QCPGraphData begin = data.at(i);
         double slope = (end.value - begin.value) / (end.key - begin.key);
         risefall.first = (max - min) / slope * 0.8;
         // Risetime je definován jako čas mezi 10 % a 90 %, toto je od min do max, tedy 0 - 100 %,
@@ -341,13 +461,13 @@ QPair<double, double> SignalProcessing::getRiseFall(QSharedPointer<QCPGraphDataC
   }
 
   // Falltime, analogicky k předchozímu...
-  for (int i = data->size() - 1; i >= 0; i--) {
-    if (data->at(i)->value <= bottom)
+  for (int i = data.size() - 1; i >= 0; i--) {
+    if (data.at(i).value <= bottom)
       fallEnd = i;
     else if (fallEnd != -1) {
-      if (data->at(i)->value >= top) {
-        QCPGraphData end = *data->at(fallEnd);
-        QCPGraphData begin = *data->at(i);
+      if (data.at(i).value >= top) {
+        QCPGraphData end = data.at(fallEnd);
+        QCPGraphData begin = data.at(i);
         double slope = (end.value - begin.value) / (end.key - begin.key);
         risefall.second = (min - max) / slope * 0.8; // min a max je prohozeno, aby výsledek nebyl záporný
         break;
@@ -20,10 +20,15 @@
 
 #include <QDebug>
 #include <QObject>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
 #include <complex>
 #include <QElapsedTimer>
 
 #include "global.h"
+#include "math/channelsnapshot.h"
+#include "math/streamingstatistics.h"
 #include "plots/qcustomplot.h"
 
 class SignalProcessing : public QObject {
@@ -37,14 +42,37 @@ class SignalProcessing : public QObject {
   void resizeBlackman(int length);
   void calculateLookupTable(int NxK);
   QVector<double> hamming, hann, blackman;
-  QVector<std::complex<double>> fft(QVector<std::complex<double>> signal);
-  inline double getStrongestFreq(QSharedPointer<QCPGraphDataContainer> data, double dc, double fs);
-  inline QPair<double, double> getRiseFall(QSharedPointer<QCPGraphDataContainer> data);
+
+  struct FFTTables {
+    /// exp(-2*pi*i*k/N) for k < N/2
+    QVector<std::complex<double>> twiddles;
+    /// Bit reversal permutation of the N/2 point complex FFT
+    QVector<int> bitReverse;
+  };
+  /// Tables for the real FFT, by length N (calculated once for each length)
+  QMap<int, FFTTables> fftTables;
+  const FFTTables &getFFTTables(int nfft);
+  /// Window of given length (nullptr for rectangular)
+  const QVector<double> *getWindow(FFTWindow::enumFFTWindow window, int length);
+  static void complexFFT(std::complex<double> *x, int n, const FFTTables &tables);
+  /// FFT of a real signal zero-padded to nfft (power of 2), result contains all nfft bins.
+  /// Only reads the tables, so it can run in several threads at once.
+  static void realFFT(const double *signal, int length, int nfft, const FFTTables &tables, QVector<std::complex<double>> &spectrum);
+  QVector<double> windowedSignal;
+  /// Welch segments processed in the shared thread pool
+  class WelchSegmentsTask;
+  /// Statistiky měřeného kanálu, aktualizují se jen o nové vzorky
+  StreamingStatistics statistics;
+  /// Poslední odhad dominantní frekvence a počet vzorků, které se od něj změnily
+  double lastFreq = Q_QNAN;
+  qint64 changedSinceFreq = 0;
+  inline double getStrongestFreq(const ChannelSnapshot &data, double dc, double fs);
+  inline QPair<double, double> getRiseFall(const ChannelSnapshot &data);
 
  public slots:
-  void getFFTPlot(QSharedPointer<QCPGraphDataContainer> data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int segmentCount, bool twosided, bool zerocenter, int minNFFT);
-  QVector<std::complex<double> > calculateSpectrum(QVector<std::complex<double>> data, FFTWindow::enumFFTWindow window, int minNFFT);
-  void process(QSharedPointer<QCPGraphDataContainer> data);
+  void getFFTPlot(ChannelSnapshot data, FFTType::enumFFTType type, FFTWindow::enumFFTWindow window, bool removeDC, int segmentCount, bool twosided, bool zerocenter, int minNFFT);
+  QVector<std::complex<double>> calculateSpectrum(const double *data, int length, FFTWindow::enumFFTWindow window, int minNFFT);
+  void process(ChannelSnapshot data);
 
  signals:
   void fftResult(QSharedPointer<QCPGraphDataContainer> data);
@@ -0,0 +1,139 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "streamingstatistics.h"
+
+void StreamingStatistics::Stats::add(double value) {
+  if (qIsNaN(value))
+    return;
+  count++;
+  double delta = value - mean;
+  mean += delta / count;
+  m2 += delta * (value - mean);
+  min = MIN(min, value);
+  max = MAX(max, value);
+}
+
+void StreamingStatistics::Stats::merge(const Stats &other) {
+  if (other.count == 0)
+    return;
+  if (count == 0) {
+    *this = other;
+    return;
+  }
+  // Sloučení průměrů a rozptylů dvou skupin (Chan et al.)
+  qint64 total = count + other.count;
+  double delta = other.mean - mean;
+  mean += delta * other.count / total;
+  m2 += other.m2 + delta * delta * count * other.count / total;
+  count = total;
+  min = MIN(min, other.min);
+  max = MAX(max, other.max);
+}
+
+void StreamingStatistics::clear() {
+  blocks.clear();
+  removedSamples = 0;
+  count = 0;
+  generation = 0;
+}
+
+qint64 StreamingStatistics::rebuild(const ChannelSnapshot &data) {
+  clear();
+  generation = data.generation();
+  removedSamples = data.startIndex();
+  appendSamples(data, 0);
+  return -1;
+}
+
+qint64 StreamingStatistics::update(const ChannelSnapshot &data) {
+  // Navázat lze jen na snímek stejné generace (data se mezi nimi jen přidávala na konec a odebírala ze začátku)
+  if (blocks.isEmpty() || data.isEmpty() || data.generation() == 0 || data.generation() != generation)
+    return rebuild(data);
+
+  // Nový snímek musí začínat uvnitř starého a končit nejdříve tam, kde starý
+  qint64 newRemovedSamples = data.startIndex();
+  qint64 end = removedSamples + count;
+  if (newRemovedSamples < removedSamples || newRemovedSamples >= end || newRemovedSamples + data.size() < end)
+    return rebuild(data);
+  int removed = newRemovedSamples - removedSamples;
+
+  // Bloky, které celé vypadly ze začátku, se zahodí
+  int dropped = 0;
+  while (blocks.at(dropped).start + blocks.at(dropped).length <= newRemovedSamples)
+    dropped++;
+  blocks.remove(0, dropped);
+  removedSamples = newRemovedSamples;
+
+  // Blok, ze kterého ubyla jen část, se spočítá znovu ze zbylých vzorků
+  Block &first = blocks.first();
+  if (first.start < removedSamples) {
+    first.length -= removedSamples - first.start;
+    first.start = removedSamples;
+    first.stats = Stats();
+    for (auto it = data.constBegin(); it != data.constBegin() + first.length; it++)
+      first.stats.add(it->value);
+  }
+
+  count -= removed;
+  int appended = data.size() - count;
+  appendSamples(data, count);
+  return removed + appended;
+}
+
+void StreamingStatistics::appendSamples(const ChannelSnapshot &data, int from) {
+  int i = from;
+  while (i < data.size()) {
+    if (blocks.isEmpty() || blocks.last().length >= MEASUREMENT_BLOCK_SIZE) {
+      Block block;
+      block.start = i + removedSamples;
+      block.length = 0;
+      blocks.append(block);
+    }
+    Block &block = blocks.last();
+    int end = MIN(data.size(), i + MEASUREMENT_BLOCK_SIZE - block.length);
+    for (auto it = data.constBegin() + i; it != data.constBegin() + end; it++)
+      block.stats.add(it->value);
+    block.length += end - i;
+    i = end;
+  }
+  count = data.size();
+}
+
+StreamingStatistics::Stats StreamingStatistics::total() const {
+  Stats result;
+  for (const Block &block : blocks)
+    result.merge(block.stats);
+  return result;
+}
+
+StreamingStatistics::Stats StreamingStatistics::tail(const ChannelSnapshot &data, int from) const {
+  Stats result;
+  for (int i = blocks.size() - 1; i >= 0; i--) {
+    const Block &block = blocks.at(i);
+    int begin = block.start - removedSamples;
+    if (begin >= from) {
+      result.merge(block.stats);
+      continue;
+    }
+    // Blok jen zčásti v rozsahu, vzorky se sečtou přímo
+    Stats partial;
+    for (auto it = data.constBegin() + from; it != data.constBegin() + begin + block.length; it++)
+      partial.add(it->value);
+    result.merge(partial);
+    break;
+  }
+  return result;
+}
@@ -0,0 +1,69 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef STREAMINGSTATISTICS_H
+#define STREAMINGSTATISTICS_H
+
+#include <math.h>
+
+#include "global.h"
+#include "math/channelsnapshot.h"
+
+/// Průběžné statistiky kanálu pro měření.
+/// Vzorky jsou rozdělené do bloků, každý má svůj počet, průměr a rozptyl (Welfordův algoritmus), minimum a maximum.
+/// Při dalším měření se zpracují jen vzorky přidané na konec, bloky které vypadly ze začátku se zahodí
+/// a přepočítá se jen první, částečně odebraný blok. Měření proudu dat tak stojí O(nových vzorků).
+/// Navazování se pozná podle generace a indexu začátku snímku, snímek jiné generace (nebo bez ní) vše spočítá znovu.
+class StreamingStatistics {
+public:
+  struct Stats {
+    qint64 count = 0;
+    double mean = 0;
+    double m2 = 0; // Součet čtverců odchylek od průměru
+    double min = Q_INFINITY;
+    double max = -Q_INFINITY;
+
+    void add(double value);
+    void merge(const Stats &other);
+    double rms() const { return count ? sqrt(m2 / count + mean * mean) : Q_QNAN; }
+  };
+
+  /// Aktualizuje statistiky podle nového snímku kanálu.
+  /// Vrací počet vzorků, které od minula přibyly nebo ubyly, nebo -1, pokud snímek nenavazuje na předchozí a vše se spočítalo znovu.
+  qint64 update(const ChannelSnapshot &data);
+  /// Statistiky celého snímku (z posledního update)
+  Stats total() const;
+  /// Statistiky vzorků snímku (z posledního update) od indexu from do konce
+  Stats tail(const ChannelSnapshot &data, int from) const;
+  void clear();
+
+private:
+  struct Block {
+    qint64 start; // Absolutní index prvního vzorku
+    int length;
+    Stats stats;
+  };
+
+  // Indexy jsou absolutní v rámci generace: index ve snímku + startIndex snímku
+  QVector<Block> blocks;
+  qint64 removedSamples = 0;
+  int count = 0;
+  quint64 generation = 0;
+
+  qint64 rebuild(const ChannelSnapshot &data);
+  void appendSamples(const ChannelSnapshot &data, int from);
+};
+
+#endif // STREAMINGSTATISTICS_H
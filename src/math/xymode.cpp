@@ -19,30 +19,89 @@ XYMode::XYMode(QObject* parent): QObject(parent) {
 
 }
 
-void XYMode::calculateXY(QSharedPointer<QCPGraphDataContainer> in1, QSharedPointer<QCPGraphDataContainer> in2, bool removeDC) {
-  if (in1->size() != in2->size()) {                                                  // Mají kanály stejný počet vzorků? Když ne, budou ustřihnut začátk nebo konec.
-    double mint = MAX(in1->at(0)->key, in2->at(0)->key);                             // Nejnižší společný čas
-    double maxt = MIN(in1->at(in1->size() - 1)->key, in2->at(in2->size() - 1)->key); // Nejvyšší společný čas
-    in1->removeBefore(mint);
-    in2->removeBefore(mint);
-    in1->removeAfter(maxt);
-    in2->removeAfter(maxt);
+double XYMode::resample(const ChannelSnapshot& channel, int index, double t, bool sinc) {
+  if (channel.size() == 1)
+    return channel.at(0).value;
+  const QCPGraphData& before = channel.at(index);
+  const QCPGraphData& after = channel.at(index + 1);
+  double frac = (after.key > before.key) ? (t - before.key) / (after.key - before.key) : 0;
+  frac = qBound(0.0, frac, 1.0);
+  if (!sinc)
+    return before.value + frac * (after.value - before.value);
+
+  // Okno Lanczos přes XY_LANCZOS_SIZE vzorků na každou stranu, váhy se normují (kraje signálu, nerovnoměrné vzorkování)
+  double sum = 0, weights = 0;
+  for (int k = index - XY_LANCZOS_SIZE + 1; k <= index + XY_LANCZOS_SIZE; k++) {
+    if (k < 0 || k >= channel.size())
+      continue;
+    double x = frac - (k - index);
+    double weight = 1;
+    if (x != 0) {
+      double px = M_PI * x;
+      weight = XY_LANCZOS_SIZE * sin(px) * sin(px / XY_LANCZOS_SIZE) / (px * px);
+    }
+    sum += weight * channel.at(k).value;
+    weights += weight;
+  }
+  return (weights != 0) ? sum / weights : before.value;
+}
+
+void XYMode::calculateXY(ChannelSnapshot in1, ChannelSnapshot in2, bool removeDC, bool sincResampling) {
+  auto result = QSharedPointer<QCPCurveDataContainer>(new QCPCurveDataContainer());
+
+  double mint = MAX(in1.at(0).key, in2.at(0).key);                            // Nejnižší společný čas
+  double maxt = MIN(in1.at(in1.size() - 1).key, in2.at(in2.size() - 1).key); // Nejvyšší společný čas
+  if (mint > maxt) {
+    emit sendResultXY(result);
+    return;
+  }
+
+  // Časová osa se vezme z kanálu, který má ve společném úseku více vzorků, druhý kanál se na ni převzorkuje.
+  // Převzorkovaný kanál se neořezává, aby šlo interpolovat i na krajích úseku.
+  ChannelSnapshot range1 = in1, range2 = in2;
+  range1.limitBefore(mint);
+  range1.limitAfter(maxt);
+  range2.limitBefore(mint);
+  range2.limitAfter(maxt);
+  bool firstIsBase = range1.size() >= range2.size();
+  const ChannelSnapshot& base = firstIsBase ? range1 : range2;
+  const ChannelSnapshot& other = firstIsBase ? in2 : in1;
+  if (base.isEmpty()) {
+    emit sendResultXY(result);
+    return;
   }
 
-  double dc1 = 0, dc2 = 0;
+  // Příliš dlouhé signály se decimují
+  int step = (base.size() + XY_MAX_POINTS - 1) / XY_MAX_POINTS;
+  int count = (base.size() + step - 1) / step;
 
+  // Jeden průchod oběma kanály zároveň, časy obou jsou seřazené
+  QVector<double> resampled(count);
+  int index = 0;
+  for (int i = 0; i < count; i++) {
+    double t = base.at(i * step).key;
+    while (index + 2 < other.size() && other.at(index + 1).key <= t)
+      index++;
+    resampled[i] = resample(other, index, t, sincResampling);
+  }
+
+  double dcBase = 0, dcOther = 0;
   if (removeDC) {
-    for (int i = 0; i < in1->size(); i++) {
-      dc1 += in1->at(i)->value;
-      dc2 += in2->at(i)->value;
+    for (int i = 0; i < count; i++) {
+      dcBase += base.at(i * step).value;
+      dcOther += resampled.at(i);
     }
-    dc1 /= in1->size();
-    dc2 /= in2->size();
+    dcBase /= count;
+    dcOther /= count;
   }
 
-  auto result = QSharedPointer<QCPCurveDataContainer>(new QCPCurveDataContainer());
-  for (int i = 0; i < in1->size(); i++) {
-    result->add(QCPCurveData(in1->at(i)->key, in1->at(i)->value - dc1, in2->at(i)->value - dc2));
+  QVector<QCPCurveData> points(count);
+  for (int i = 0; i < count; i++) {
+    const QCPGraphData& sample = base.at(i * step);
+    double baseValue = sample.value - dcBase;
+    double otherValue = resampled.at(i) - dcOther;
+    points[i] = firstIsBase ? QCPCurveData(sample.key, baseValue, otherValue) : QCPCurveData(sample.key, otherValue, baseValue);
   }
+  result->set(points, true);
   emit sendResultXY(result);
 }
@@ -19,6 +19,7 @@
 #include <QObject>
 
 #include "global.h"
+#include "math/channelsnapshot.h"
 #include "plots/qcustomplot.h"
 
 class XYMode : public QObject {
@@ -26,8 +27,12 @@ class XYMode : public QObject {
  public:
   explicit XYMode(QObject* parent = nullptr);
 
+ private:
+  /// Hodnota kanálu v čase t mezi vzorky index a index + 1 (lineárně nebo oknem Lanczos)
+  static double resample(const ChannelSnapshot& channel, int index, double t, bool sinc);
+
  public slots:
-  void calculateXY(QSharedPointer<QCPGraphDataContainer> in1, QSharedPointer<QCPGraphDataContainer> in2, bool removeDC);
+  void calculateXY(ChannelSnapshot in1, ChannelSnapshot in2, bool removeDC, bool sincResampling);
 
  signals:
   void sendResultXY(QSharedPointer<QCPCurveDataContainer> result);
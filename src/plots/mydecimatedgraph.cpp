@@ -0,0 +1,200 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "mydecimatedgraph.h"
+
+qint64 MyDecimatedGraph::blockSize(int level) {
+  qint64 size = DECIMATION_BASE_BLOCK;
+  for (int i = 0; i < level; i++)
+    size *= DECIMATION_LEVEL_FACTOR;
+  return size;
+}
+
+void MyDecimatedGraph::dataRemovedFromFront(int count) {
+  if (count <= 0 || summarizedData.toStrongRef() != mDataContainer)
+    return;
+  removedSamples += count;
+
+  // Bloky, které zasahují do odebraných vzorků, se už nepoužijí.
+  // Mažou se až když jich je víc než platných (mazání ze začátku QVectoru posouvá zbytek).
+  for (int level = 0; level < levels.size(); level++) {
+    qint64 size = blockSize(level);
+    qint64 firstValid = (removedSamples + size - 1) / size;
+    qint64 invalid = qMin(firstValid - levelFirstBlock.at(level), qint64(levels.at(level).size()));
+    if (invalid > 0 && invalid > levels.at(level).size() / 2) {
+      levels[level].remove(0, int(invalid));
+      levelFirstBlock[level] += invalid;
+    }
+  }
+}
+
+void MyDecimatedGraph::invalidateSummary() {
+  summarizedData.clear();
+  levels.clear();
+  levelFirstBlock.clear();
+}
+
+void MyDecimatedGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const {
+  if (lineData && getDecimatedData(lineData, begin, end))
+    return;
+  QCPGraph::getOptimizedLineData(lineData, begin, end);
+}
+
+void MyDecimatedGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const {
+  if (scatterData && mScatterSkip == 0 && getDecimatedData(scatterData, begin, end))
+    return;
+  QCPGraph::getOptimizedScatterData(scatterData, begin, end);
+}
+
+bool MyDecimatedGraph::getDecimatedData(QVector<QCPGraphData> *data, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const {
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!mAdaptiveSampling || !keyAxis || begin == end)
+    return false;
+
+  // Souhrn má smysl, až když na každý pixel připadá aspoň jeden celý blok nejnižší úrovně,
+  // jinak stačí původní algoritmus QCustomPlot (ten ale prochází všechny vzorky v rozsahu).
+  qint64 count = end - begin;
+  double pixels = qAbs(keyAxis->coordToPixel(begin->key) - keyAxis->coordToPixel((end - 1)->key)) + 1;
+  if (count < DECIMATION_BASE_BLOCK * pixels)
+    return false;
+
+  updateSummary();
+
+  // Nejhrubší úroveň, která má ještě aspoň jeden blok na pixel
+  int level = -1;
+  while (level + 1 < levels.size() && blockSize(level + 1) * pixels <= count)
+    level++;
+  if (level < 0)
+    return false;
+
+  qint64 from = removedSamples + (begin - mDataContainer->constBegin());
+  data->clear();
+  data->reserve(int(4 * pixels));
+  appendRange(data, from, from + count, level);
+  return true;
+}
+
+void MyDecimatedGraph::appendRange(QVector<QCPGraphData> *data, qint64 from, qint64 to, int level) const {
+  if (from >= to)
+    return;
+
+  if (level < 0) {
+    // Původní vzorky
+    auto it = mDataContainer->constBegin() + (from - removedSamples);
+    auto itEnd = mDataContainer->constBegin() + (to - removedSamples);
+    for (; it != itEnd; it++)
+      data->append(*it);
+    return;
+  }
+
+  // Použitelné jsou jen celé bloky uvnitř rozsahu, které ještě obsahují jen platné vzorky.
+  // Okraje (a chybějící bloky) se doplní z jemnější úrovně.
+  const QVector<MinMaxBlock> &blocks = levels.at(level);
+  qint64 size = blockSize(level);
+  qint64 firstBlock = qMax(qMax((from + size - 1) / size, (removedSamples + size - 1) / size), levelFirstBlock.at(level));
+  qint64 endBlock = qMin(to / size, levelFirstBlock.at(level) + blocks.size());
+  if (firstBlock >= endBlock) {
+    appendRange(data, from, to, level - 1);
+    return;
+  }
+
+  appendRange(data, from, firstBlock * size, level - 1);
+  for (qint64 i = firstBlock; i < endBlock; i++) {
+    const MinMaxBlock &block = blocks.at(int(i - levelFirstBlock.at(level)));
+    // Minimum a maximum ve správném pořadí podle času
+    if (block.minKey <= block.maxKey) {
+      data->append(QCPGraphData(block.minKey, block.minValue));
+      data->append(QCPGraphData(block.maxKey, block.maxValue));
+    } else {
+      data->append(QCPGraphData(block.maxKey, block.maxValue));
+      data->append(QCPGraphData(block.minKey, block.minValue));
+    }
+  }
+  appendRange(data, endBlock * size, to, level - 1);
+}
+
+void MyDecimatedGraph::updateSummary() const {
+  const QCPGraphDataContainer *container = mDataContainer.data();
+
+  // Kontejner byl vyměněn (setData), nebo v něm neplatí poslední shrnutý vzorek (data nebyla jen přidána na konec)
+  bool valid = summarizedData.toStrongRef() == mDataContainer;
+  if (valid && summarizedSamples > removedSamples) {
+    qint64 lastIndex = summarizedSamples - removedSamples - 1;
+    valid = lastIndex < container->size() && (container->constBegin() + lastIndex)->key == lastSummarizedKey;
+  }
+  if (!valid) {
+    invalidateSummary();
+    summarizedData = mDataContainer;
+    removedSamples = 0;
+    summarizedSamples = 0;
+  }
+
+  // Vše shrnuté už bylo odebráno, souhrn začne od prvního celého bloku
+  if (summarizedSamples < removedSamples) {
+    levels.clear();
+    levelFirstBlock.clear();
+    summarizedSamples = (removedSamples + DECIMATION_BASE_BLOCK - 1) / DECIMATION_BASE_BLOCK * DECIMATION_BASE_BLOCK;
+  }
+
+  qint64 available = removedSamples + container->size();
+  while (summarizedSamples + DECIMATION_BASE_BLOCK <= available) {
+    auto it = container->constBegin() + (summarizedSamples - removedSamples);
+    auto itEnd = it + DECIMATION_BASE_BLOCK;
+    MinMaxBlock block = {it->key, qQNaN(), it->key, qQNaN()};
+    for (; it != itEnd; it++) {
+      if (qIsNaN(it->value))
+        continue;
+      if (qIsNaN(block.minValue) || it->value < block.minValue) {
+        block.minValue = it->value;
+        block.minKey = it->key;
+      }
+      if (qIsNaN(block.maxValue) || it->value > block.maxValue) {
+        block.maxValue = it->value;
+        block.maxKey = it->key;
+      }
+    }
+    lastSummarizedKey = (itEnd - 1)->key;
+    appendBlock(0, summarizedSamples / DECIMATION_BASE_BLOCK, block);
+    summarizedSamples += DECIMATION_BASE_BLOCK;
+  }
+}
+
+void MyDecimatedGraph::appendBlock(int level, qint64 index, const MinMaxBlock &block) const {
+  if (levels.size() <= level) {
+    levels.resize(level + 1);
+    levelFirstBlock.resize(level + 1);
+  }
+  QVector<MinMaxBlock> &blocks = levels[level];
+  if (blocks.isEmpty())
+    levelFirstBlock[level] = index;
+  blocks.append(block);
+
+  // Dokončen blok vyšší úrovně?
+  if ((index + 1) % DECIMATION_LEVEL_FACTOR != 0 || index + 1 - DECIMATION_LEVEL_FACTOR < levelFirstBlock.at(level))
+    return;
+  MinMaxBlock parent = {block.minKey, qQNaN(), block.maxKey, qQNaN()};
+  for (int i = blocks.size() - DECIMATION_LEVEL_FACTOR; i < blocks.size(); i++) {
+    const MinMaxBlock &child = blocks.at(i);
+    if (!qIsNaN(child.minValue) && (qIsNaN(parent.minValue) || child.minValue < parent.minValue)) {
+      parent.minValue = child.minValue;
+      parent.minKey = child.minKey;
+    }
+    if (!qIsNaN(child.maxValue) && (qIsNaN(parent.maxValue) || child.maxValue > parent.maxValue)) {
+      parent.maxValue = child.maxValue;
+      parent.maxKey = child.maxKey;
+    }
+  }
+  appendBlock(level + 1, index / DECIMATION_LEVEL_FACTOR, parent);
+}
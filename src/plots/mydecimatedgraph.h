@@ -0,0 +1,63 @@
+//  Copyright (C) 2020-2024  Jiří Maier
+
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef MYDECIMATEDGRAPH_H
+#define MYDECIMATEDGRAPH_H
+
+#include "global.h"
+#include "plots/qcustomplot.h"
+
+/// Graf, který si k datům vede víceúrovňový souhrn minim a maxim (bloky vzorků).
+/// Při oddálení se kreslí z úrovně odpovídající šířce v pixelech, takže čas překreslení
+/// nezávisí na počtu vzorků. Při přiblížení (méně vzorků než pixelů) se kreslí původní vzorky.
+class MyDecimatedGraph : public QCPGraph {
+  Q_OBJECT
+public:
+  explicit MyDecimatedGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) : QCPGraph(keyAxis, valueAxis) {}
+
+  /// Ze začátku dat bylo odebráno count vzorků (souhrn zbytku zůstává platný)
+  void dataRemovedFromFront(int count);
+
+  /// Data byla změněna jinak než přidáním na konec (např. vymazána), souhrn se vytvoří znovu
+  void invalidateSummary();
+
+protected:
+  void getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const override;
+  void getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const override;
+
+private:
+  struct MinMaxBlock {
+    double minKey, minValue, maxKey, maxValue;
+  };
+
+  /// Počet vzorků v bloku dané úrovně
+  static qint64 blockSize(int level);
+
+  bool getDecimatedData(QVector<QCPGraphData> *data, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const;
+  void appendRange(QVector<QCPGraphData> *data, qint64 from, qint64 to, int level) const;
+  void updateSummary() const;
+  void appendBlock(int level, qint64 index, const MinMaxBlock &block) const;
+
+  // Souhrn se počítá až při kreslení (skrytý nebo krátký kanál nic nestojí), proto mutable.
+  // Indexy vzorků jsou absolutní: index v kontejneru + počet vzorků odebraných ze začátku.
+  mutable QWeakPointer<QCPGraphDataContainer> summarizedData;
+  mutable QVector<QVector<MinMaxBlock>> levels;
+  mutable QVector<qint64> levelFirstBlock;
+  mutable qint64 removedSamples = 0;
+  mutable qint64 summarizedSamples = 0;
+  mutable double lastSummarizedKey = 0;
+};
+
+#endif // MYDECIMATEDGRAPH_H
@@ -21,12 +21,13 @@ MyMainPlot::MyMainPlot(QWidget *parent) : MyPlot(parent) {
   yAxis->setRange(0, 10, Qt::AlignCenter);
   channelSettings.resize(ANALOG_COUNT + MATH_COUNT);
   logicSettings.resize(LOGIC_GROUPS);
+  histories.resize(ALL_COUNT);
 
   for (int i = 0; i < ANALOG_COUNT + MATH_COUNT; i++) {
     zeroLines.append(new QCPItemLine(this));
     analogAxis.append(this->axisRect()->addAxis(QCPAxis::atRight, 0));
     analogAxis.last()->setRange(yAxis->range());
-    addGraph(xAxis, analogAxis.last());
+    new MyDecimatedGraph(xAxis, analogAxis.last()); // Graf se sám zaregistruje do plotu (jako u addGraph)
     analogAxis.last()->setTicks(false);
     analogAxis.last()->setBasePen(Qt::NoPen);
     analogAxis.last()->setOffset(0);
@@ -39,7 +40,7 @@ MyMainPlot::MyMainPlot(QWidget *parent) : MyPlot(parent) {
     logicGroupAxis.append(this->axisRect()->addAxis(QCPAxis::atRight, 0));
     logicGroupAxis.last()->setRange(yAxis->range());
     for (int j = 0; j < LOGIC_BITS; j++) {
-      addGraph(xAxis, logicGroupAxis.last());
+      new MyDecimatedGraph(xAxis, logicGroupAxis.last());
       // graph(graphCount() - 1)->setFillBase(j * 3);
     }
     logicGroupAxis.last()->setTicks(false);
@@ -53,7 +54,7 @@ MyMainPlot::MyMainPlot(QWidget *parent) : MyPlot(parent) {
 
   // Interpolační kanály
   for (int i = 0; i < ANALOG_COUNT + MATH_COUNT; i++) {
-    addGraph(xAxis, analogAxis.at(i));
+    new MyDecimatedGraph(xAxis, analogAxis.at(i));
   }
 
   initZeroLines();
@@ -459,8 +460,10 @@ void MyMainPlot::resume() {
   plottingStatus = PlotStatus::run;
   emit showPlotStatus(plottingStatus);
   for (int i = 0; i < ALL_COUNT; i++) {
-    if (!pauseBuffer.at(i).data()->isEmpty())
+    if (!pauseBuffer.at(i).data()->isEmpty()) {
       graph(i)->setData(pauseBuffer.at(i));
+      histories[i].invalidate();
+    }
   }
   pauseBuffer.clear();
   newData = true;
@@ -500,7 +503,9 @@ void MyMainPlot::clearLogicGroup(int number, int fromBit) {
 }
 
 void MyMainPlot::clearCh(int chID) {
-  this->graph(chID)->data().data()->clear(); // Odstraní kanál
+  writableData(chID, true); // Odstraní kanál
+  decimatedGraph(chID)->invalidateSummary();
+  histories[chID].clear();
   if (chID < ANALOG_COUNT + MATH_COUNT)
     this->graph(INTERPOLATION_CHID(chID))->data().data()->clear(); // Odstraní graf interpolace
   if (plottingStatus == PlotStatus::pause)
@@ -542,14 +547,17 @@ void MyMainPlot::newDataVector(int chID, QSharedPointer<QCPGraphDataContainer> d
       }
     }
     this->graph(chID)->setData(data);
+    histories[chID].adopt(data); // Rámec se už nemění, snímky ho jen sdílí
     newData = true;
   }
   setLastDataTypeWasPoint(false);
 }
 
 void MyMainPlot::newInterpolatedVector(int chID, QSharedPointer<QCPGraphDataContainer> dataOriginal, QSharedPointer<QCPGraphDataContainer> dataInterpolated, bool dataIsFromInterpolationBuffer) {
-  if (dataIsFromInterpolationBuffer)
+  if (dataIsFromInterpolationBuffer) {
     this->graph(chID)->setData(dataOriginal);
+    histories[chID].adopt(dataOriginal);
+  }
   this->graph(INTERPOLATION_CHID(chID))->setData(dataInterpolated);
   newData = true;
   setLastDataTypeWasPoint(false);
@@ -624,30 +632,110 @@ void MyMainPlot::setTheme(QColor fnt, QColor bck, int chClrThemeId) {
 
 void MyMainPlot::newDataPoint(int chID, double time, double value, bool append) {
   if (plottingStatus != PlotStatus::pause) {
+    QCPGraphDataContainer &graphData = writableData(chID, !append);
     if (!append) {
-      this->graph(chID)->data()->clear();
       this->graph(INTERPOLATION_CHID(chID))->data()->clear();
+      decimatedGraph(chID)->invalidateSummary();
+      histories[chID].clear();
     }
-    this->graph(chID)->addData(time, value);
+    QCPGraphData point(time, value);
+    graphData.add(point);
+    int removed = enforcePointCapacity(graphData);
+    decimatedGraph(chID)->dataRemovedFromFront(removed);
+    updateHistory(chID, &point, 1, removed);
     newData = true;
   } else {
     if (!append)
       pauseBuffer.at(chID)->clear();
     pauseBuffer.at(chID)->add(QCPGraphData(time, value));
+    enforcePointCapacity(*pauseBuffer.at(chID));
+  }
+  if (autoVRage)
+    updateAutoVRange(chID, value);
+  setLastDataTypeWasPoint(true);
+}
+
+void MyMainPlot::newDataPoints(int chID, QSharedPointer<QCPGraphDataContainer> data, bool append) {
+  if (data->isEmpty())
+    return;
+  if (plottingStatus != PlotStatus::pause) {
+    QCPGraphDataContainer &graphData = writableData(chID, !append);
+    if (!append) {
+      this->graph(INTERPOLATION_CHID(chID))->data()->clear();
+      decimatedGraph(chID)->invalidateSummary();
+      histories[chID].clear();
+    }
+    graphData.add(*data); // Celý blok najednou
+    int removed = enforcePointCapacity(graphData);
+    decimatedGraph(chID)->dataRemovedFromFront(removed);
+    updateHistory(chID, &*data->constBegin(), data->size(), removed);
+    newData = true;
+  } else {
+    if (!append)
+      pauseBuffer.at(chID)->clear();
+    pauseBuffer.at(chID)->add(*data);
+    enforcePointCapacity(*pauseBuffer.at(chID));
   }
   if (autoVRage) {
-    double absoluteValueCoord = yAxis->pixelToCoord(graph(chID)->valueAxis()->coordToPixel(value));
-    if (absoluteValueCoord > maxZoomY.upper) {
-      setMaxZoomY(QCPRange(maxZoomY.lower, ceilToNiceValue(absoluteValueCoord)), qFuzzyCompare(yAxis->range().lower, maxZoomY.lower) && qFuzzyCompare(yAxis->range().upper, maxZoomY.upper));
-      emit vRangeMaxChanged(maxZoomY);
-    } else if (absoluteValueCoord < maxZoomY.lower) {
-      setMaxZoomY(QCPRange(floorToNiceValue(absoluteValueCoord), maxZoomY.upper), qFuzzyCompare(yAxis->range().lower, maxZoomY.lower) && qFuzzyCompare(yAxis->range().upper, maxZoomY.upper));
-      emit vRangeMaxChanged(maxZoomY);
+    bool foundRange;
+    QCPRange range = data->valueRange(foundRange);
+    if (foundRange) {
+      updateAutoVRange(chID, range.upper);
+      updateAutoVRange(chID, range.lower);
     }
   }
   setLastDataTypeWasPoint(true);
 }
 
+void MyMainPlot::updateHistory(int chID, const QCPGraphData *added, int count, int removed) {
+  ChannelHistory &history = histories[chID];
+  if (!history.isValid())
+    return;
+  // Vzorky zatříděné dovnitř kanálu historie nezvládne, neplatnou historii snímek vytvoří znovu
+  if (history.append(added, count))
+    history.removeFront(removed);
+}
+
+QCPGraphDataContainer &MyMainPlot::writableData(int chID, bool clear) {
+  if (histories.at(chID).isAdopted(graph(chID)->data())) {
+    // Převzatý rámec můžou právě číst snímky v jiných vláknech, graf dostane nový kontejner (kopii jen pokud se má doplňovat)
+    if (clear)
+      graph(chID)->setData(QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer));
+    else
+      graph(chID)->setData(QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer(*graph(chID)->data())));
+    histories[chID].invalidate();
+  } else if (clear)
+    graph(chID)->data()->clear();
+  return *graph(chID)->data();
+}
+
+ChannelSnapshot MyMainPlot::snapshot(int chID) {
+  if (!histories.at(chID).isValid())
+    histories[chID].reset(*graph(chID)->data());
+  return histories.at(chID).snapshot(chID);
+}
+
+int MyMainPlot::enforcePointCapacity(QCPGraphDataContainer &data) {
+  if (!rollingMode || pointCapacity <= 0 || data.size() <= pointCapacity)
+    return 0;
+  // Kontejner odstraněné vzorky ze začátku nemaže, jen posune začátek (a občas paměť zmenší),
+  // takže odebírání nejstarších vzorků je (amortizovaně) O(1).
+  int sizeBefore = data.size();
+  data.removeBefore(data.at(data.size() - pointCapacity)->key);
+  return sizeBefore - data.size();
+}
+
+void MyMainPlot::updateAutoVRange(int chID, double value) {
+  double absoluteValueCoord = yAxis->pixelToCoord(graph(chID)->valueAxis()->coordToPixel(value));
+  if (absoluteValueCoord > maxZoomY.upper) {
+    setMaxZoomY(QCPRange(maxZoomY.lower, ceilToNiceValue(absoluteValueCoord)), qFuzzyCompare(yAxis->range().lower, maxZoomY.lower) && qFuzzyCompare(yAxis->range().upper, maxZoomY.upper));
+    emit vRangeMaxChanged(maxZoomY);
+  } else if (absoluteValueCoord < maxZoomY.lower) {
+    setMaxZoomY(QCPRange(floorToNiceValue(absoluteValueCoord), maxZoomY.upper), qFuzzyCompare(yAxis->range().lower, maxZoomY.lower) && qFuzzyCompare(yAxis->range().upper, maxZoomY.upper));
+    emit vRangeMaxChanged(maxZoomY);
+  }
+}
+
 QByteArray MyMainPlot::exportChannelCSV(char separator, char decimal, int chID, int precision, bool onlyInView) {
   if (graph(chID)->data()->isEmpty())
     return "";
@@ -690,42 +778,21 @@ QByteArray MyMainPlot::exportLogicCSV(char separator, char decimal, int group, i
   return output;
 }
 
-QByteArray MyMainPlot::exportAllCSV(char separator, char decimal, int precision, bool onlyInView, bool includeHidden) {
-  QByteArray output = "";
-  QVector<QPair<QVector<double>, QVector<double>>> channels;
-  bool firstNonEmpty = true;
+QVector<TableExporter::Column> MyMainPlot::exportAllColumns(bool onlyInView, bool includeHidden) {
+  QVector<TableExporter::Column> columns;
   for (int i = 0; i < ALL_COUNT; i++) {
     if (!graph(i)->data()->isEmpty() && (graph(i)->visible() || includeHidden)) {
-      if (firstNonEmpty) {
-        firstNonEmpty = false;
-        output.append(tr("time").toUtf8());
-      }
-      channels.append(getDataVector(i, onlyInView));
-      output.append(separator);
-      output.append(getChName(i).toUtf8());
-    }
-  }
-  QList<double> times;
-  for (QVector<QPair<QVector<double>, QVector<double>>>::iterator it = channels.begin(); it != channels.end(); it++)
-    foreach (double time, it->first)
-      if (!times.contains(time))
-        times.append(time);
-  std::sort(times.begin(), times.end());
-
-  foreach (double time, times) {
-    output.append('\n');
-    output.append(QString::number(time, 'f', precision).replace('.', decimal).toUtf8());
-    for (QVector<QPair<QVector<double>, QVector<double>>>::iterator it = channels.begin(); it != channels.end(); it++) {
-      output.append(separator);
-      if (!it->first.isEmpty())
-        if (it->first.first() == time) {
-          output.append(QString::number(it->second.first(), 'f', precision).replace('.', decimal).toUtf8());
-          it->first.pop_front();
-          it->second.pop_front();
-        }
+      TableExporter::Column column;
+      column.name = getChName(i);
+      // Rámce se jen sdílí, u kanálů z bodů vznikne kopie jen při prvním snímku (pak se historie doplňuje)
+      column.data = snapshot(i);
+      if (onlyInView)
+        column.data.limitRange(xAxis->range());
+      column.isLogic = IS_LOGIC_CH(i);
+      columns.append(column);
     }
   }
-  return output;
+  return columns;
 }
 
 void MyMainPlot::mouseMoved(QMouseEvent *event) {
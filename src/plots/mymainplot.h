@@ -19,6 +19,8 @@
 #include <QTimer>
 
 #include "communication/plotdata.h"
+#include "communication/tableexporter.h"
+#include "mydecimatedgraph.h"
 #include "myplot.h"
 
 class MyMainPlot : public MyPlot {
@@ -130,8 +132,11 @@ public:
   /// Exportuje skupinu logických kanálů
   QByteArray exportLogicCSV(char separator, char decimal, int group, int precision, bool onlyInView);
 
-  /// Exportuje vše (včetně logických)
-  QByteArray exportAllCSV(char separator, char decimal, int precision, bool onlyInView, bool includeHidden);
+  /// Snímek dat kanálu pro výpočet v jiném vlákně (rámec se sdílí, kanál z bodů se poprvé zkopíruje, viz ChannelHistory)
+  ChannelSnapshot snapshot(int chID);
+
+  /// Sloupce pro export všeho (včetně logických)
+  QVector<TableExporter::Column> exportAllColumns(bool onlyInView, bool includeHidden);
 
   /// Vrátí osu hodnot zadaného kanálu
   QCPAxis *getAnalogAxis(int chID) const { return analogAxis.at(chID); }
@@ -158,6 +163,9 @@ public:
   bool getAutoVRage() const;
   void setAutoVRage(bool newAutoVRage);
 
+  /// Nastaví maximální počet vzorků kanálu v rolling režimu (0 = neomezeno)
+  void setPointCapacity(int samples) { pointCapacity = samples; }
+
 private:
   void redraw();
 
@@ -188,6 +196,12 @@ private:
 
   QList<QCPAxis *> analogAxis, logicGroupAxis;
   QVector<QSharedPointer<QCPGraphDataContainer>> pauseBuffer;
+  /// Data kanálů pro snímky (rámce převzaté bez kopie, kanály z bodů zkopírované při prvním snímku)
+  QVector<ChannelHistory> histories;
+  /// Přidá do historie vzorky přidané na konec kanálu a odebere ty, které vypadly ze začátku
+  void updateHistory(int chID, const QCPGraphData *added, int count, int removed);
+  /// Data grafu, která lze měnit na místě (převzatý rámec nahradí kopií), s clear prázdná
+  QCPGraphDataContainer &writableData(int chID, bool clear);
   QVector<ChannelSettings_t> channelSettings;
   QVector<ChannelSettings_t> logicSettings;
   QVector<QCPItemLine *> zeroLines;
@@ -200,6 +214,11 @@ private:
   enum Mode { free, growing, rolling, empty, free_locked } mode = empty;
   double lastSignalEnd = 0;
   void updateRollingState(double xMax);
+  void updateAutoVRange(int chID, double value);
+  int pointCapacity = 0;
+  /// Vrátí počet odebraných vzorků
+  int enforcePointCapacity(QCPGraphDataContainer &data);
+  MyDecimatedGraph *decimatedGraph(int chID) { return static_cast<MyDecimatedGraph *>(graph(chID)); }
   bool lastDataTypeWasPoint = false;
 
   bool autoVRage = false;
@@ -231,6 +250,9 @@ public slots:
   /// Přidá bod do kanálu
   void newDataPoint(int chID, double time, double value, bool append);
 
+  /// Přidá blok bodů do kanálu (append = false kanál nejdříve vymaže)
+  void newDataPoints(int chID, QSharedPointer<QCPGraphDataContainer> data, bool append);
+
   /// Přepíše data v kanálu, pokud je zde jen jeden bod, přidá ho jako bod
   /// (nepřepíše původní).
   void newDataVector(int chID, QSharedPointer<QCPGraphDataContainer> data, bool ignorePause = false);
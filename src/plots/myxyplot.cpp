@@ -19,6 +19,7 @@ MyXYPlot::MyXYPlot(QWidget *parent) : MyPlot(parent) {
   xAxis->setSubTicks(false);
   yAxis->setSubTicks(false);
   graphXY = new QCPCurve(this->xAxis, this->yAxis);
+  addLayer("persistence", layer("main"), QCustomPlot::limBelow);
   this->xAxis->setRange(-100, 100);
   this->yAxis->setRange(-100, 100);
   setGridHintX(-3);
@@ -31,6 +32,12 @@ MyXYPlot::MyXYPlot(QWidget *parent) : MyPlot(parent) {
 MyXYPlot::~MyXYPlot() {}
 
 void MyXYPlot::newData(QSharedPointer<QCPCurveDataContainer> data) {
+  // Snímky se posunou o jeden dozadu (předávají se jen ukazatele na data)
+  if (!history.isEmpty()) {
+    for (int i = history.size() - 1; i > 0; i--)
+      history.at(i)->setData(history.at(i - 1)->data());
+    history.first()->setData(graphXY->data());
+  }
   graphXY->setData(data);
   this->replot(QCustomPlot::RefreshPriority::rpQueuedReplot);
 
@@ -41,6 +48,8 @@ void MyXYPlot::newData(QSharedPointer<QCPCurveDataContainer> data) {
 
 void MyXYPlot::clear() {
   graphXY->data().data()->clear();
+  for (auto curve : qAsConst(history))
+    curve->setData(QSharedPointer<QCPCurveDataContainer>(new QCPCurveDataContainer()));
   rangeUnknown = true;
   setMaxZoomX(QCPRange(-10, 10), true);
   setMaxZoomY(QCPRange(-10, 10), true);
@@ -58,9 +67,34 @@ void MyXYPlot::setStyle(int style) {
     graphXY->setScatterStyle(POINT_STYLE);
     graphXY->setLineStyle(QCPCurve::lsLine);
   }
+  updateHistoryStyle();
+  this->replot(QCustomPlot::RefreshPriority::rpQueuedReplot);
+}
+
+void MyXYPlot::setPersistence(int frames) {
+  while (history.size() > frames)
+    removePlottable(history.takeLast());
+  while (history.size() < frames) {
+    QCPCurve *curve = new QCPCurve(this->xAxis, this->yAxis);
+    curve->setLayer("persistence");
+    curve->setSelectable(QCP::stNone);
+    history.append(curve);
+  }
+  updateHistoryStyle();
   this->replot(QCustomPlot::RefreshPriority::rpQueuedReplot);
 }
 
+void MyXYPlot::updateHistoryStyle() {
+  QColor clr = graphXY->pen().color();
+  for (int i = 0; i < history.size(); i++) {
+    QColor faded = clr;
+    faded.setAlphaF(clr.alphaF() * (history.size() - i) / (history.size() + 1));
+    history.at(i)->setPen(faded);
+    history.at(i)->setLineStyle(graphXY->lineStyle());
+    history.at(i)->setScatterStyle(graphXY->scatterStyle());
+  }
+}
+
 void MyXYPlot::setColor(QColor clr, int theme) {
   if (theme == 1)
     clr1 = clr;
@@ -68,6 +102,7 @@ void MyXYPlot::setColor(QColor clr, int theme) {
     clr2 = clr;
   if (theme == chClrTheme) {
     graphXY->setPen(clr);
+    updateHistoryStyle();
     this->replot(QCustomPlot::RefreshPriority::rpQueuedReplot);
   }
 }
@@ -75,6 +110,7 @@ void MyXYPlot::setColor(QColor clr, int theme) {
 void MyXYPlot::setTheme(QColor fnt, QColor bck, int chClrThemeId) {
   MyPlot::setTheme(fnt, bck, chClrThemeId);
   graphXY->setPen(chClrTheme == 1 ? clr1 : clr2);
+  updateHistoryStyle();
   this->replot(QCustomPlot::RefreshPriority::rpQueuedReplot);
 }
 
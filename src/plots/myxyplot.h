@@ -32,6 +32,9 @@ public:
 
 private:
   QSharedPointer<QCPCurveDataContainer> pauseBuffer;
+  /// Předchozí snímky (od nejnovějšího), vykreslují se pod aktuálním s klesající sytostí barvy
+  QList<QCPCurve *> history;
+  void updateHistoryStyle();
   void updateTracerText();
   bool rangeUnknown = true;
 
@@ -46,6 +49,7 @@ public slots:
   void newData(QSharedPointer<QCPCurveDataContainer> data);
   void clear();
   void setStyle(int style);
+  void setPersistence(int frames);
   void setColor(QColor clr, int theme);
 
 signals:
@@ -191,15 +191,17 @@ UnitOfMeasure::UnitOfMeasure(QString rawUnit) {
   }
 }
 
-ValueType readValuePrefix(QByteArray &buffer, int &detectedPrefixLength) {
+ValueType readValuePrefix(const QByteArray &buffer, int &detectedPrefixLength) { return readValuePrefix(buffer.constData(), buffer.length(), detectedPrefixLength); }
+
+ValueType readValuePrefix(const char *data, int length, int &detectedPrefixLength) {
   ValueType valType;
-  if (buffer.length() < 2)
+  if (length < 2)
     return valType; // Incomplete
-  if (!isdigit(buffer.at(1))) {
+  if (!isdigit(data[1])) {
     detectedPrefixLength = 3;
-    if (buffer.length() < 3)
+    if (length < 3)
       return valType; // Incomplete
-    switch (buffer.at(0)) {
+    switch (data[0]) {
     case 'T':
       valType.multiplier = 1e12;
       break;
@@ -253,22 +255,22 @@ ValueType readValuePrefix(QByteArray &buffer, int &detectedPrefixLength) {
 #define typePosition detectedPrefixLength - 2
 #define bytesPosition detectedPrefixLength - 1
 
-  switch (tolower(buffer.at(typePosition))) {
+  switch (tolower(data[typePosition])) {
   case 'u':
     valType.type = ValueType::unsignedint;
-    valType.bytes = buffer.at(bytesPosition) - '0';
+    valType.bytes = data[bytesPosition] - '0';
     if (valType.bytes != 1 && valType.bytes != 2 && valType.bytes != 3 && valType.bytes != 4)
       valType.type = ValueType::invalid;
     break;
   case 'i':
     valType.type = ValueType::integer;
-    valType.bytes = buffer.at(bytesPosition) - '0';
+    valType.bytes = data[bytesPosition] - '0';
     if (valType.bytes != 1 && valType.bytes != 2 && valType.bytes != 4)
       valType.type = ValueType::invalid;
     break;
   case 'f':
     valType.type = ValueType::floatingpoint;
-    valType.bytes = buffer.at(bytesPosition) - '0';
+    valType.bytes = data[bytesPosition] - '0';
     if (valType.bytes != 4 && valType.bytes != 8)
       valType.type = ValueType::invalid;
     break;
@@ -276,7 +278,7 @@ ValueType readValuePrefix(QByteArray &buffer, int &detectedPrefixLength) {
     valType.type = ValueType::invalid;
     return valType; // Invalid
   }
-  valType.bigEndian = (buffer.at(typePosition) == toupper(buffer.at(typePosition)));
+  valType.bigEndian = (data[typePosition] == toupper(data[typePosition]));
   return valType;
 }
 
@@ -49,6 +49,10 @@ namespace MathOperations {
 enum enumMathOperations { add = 0, subtract = 1, multiply = 2, divide = 3 };
 }
 
+namespace AverageMode {
+enum enumAverageMode { mean = 0, exponential = 1, median = 2 };
+}
+
 namespace DataLineType {
 enum enumDataLineType { command, dataEnded, dataTimeouted, dataImplicitEnded, debugMessage };
 }
@@ -93,7 +97,8 @@ struct ValueType {
   double multiplier = 1.0;
 };
 
-ValueType readValuePrefix(QByteArray &buffer, int &detectedPrefixLength);
+ValueType readValuePrefix(const QByteArray &buffer, int &detectedPrefixLength);
+ValueType readValuePrefix(const char *data, int length, int &detectedPrefixLength);
 
 QString valueTypeToString(ValueType val);
 